@@ -0,0 +1,253 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <esp_log.h>
+#include <lvgl.h>
+
+#include "countdown_widget.h"
+
+static const char *TAG = "countdown";
+
+#define COUNTDOWN_CELLS   5    // "MM:SS"
+#define COUNTDOWN_GLYPHS  11   // 0-9 and ':'
+#define COUNTDOWN_COLON   10   // Glyph index of ':'
+
+// Constant strings, so queued label draw tasks never see a reused buffer
+static const char *const s_glyph_text[COUNTDOWN_GLYPHS] = {
+    "0", "1", "2", "3", "4", "5", "6", "7", "8", "9", ":"
+};
+
+typedef struct {
+    const lv_font_t *font;
+    lv_color_t color;
+    uint8_t glyph[COUNTDOWN_CELLS];   // Glyph index shown in each cell
+    int32_t cell_x[COUNTDOWN_CELLS];  // Cell offset from the widget's left edge
+    int32_t digit_w;                  // Widest digit advance, every digit cell has this width
+    int32_t colon_w;
+    int32_t ink_y;                    // First row of the line box any glyph covers
+    int32_t ink_h;                    // Rows covered by any glyph
+    uint8_t *atlas;                   // RGB565 glyphs side by side, NULL = draw as text
+    lv_image_dsc_t glyph_img[COUNTDOWN_GLYPHS];
+} countdown_widget_t;
+
+static int32_t countdown_glyph_w(const countdown_widget_t *cw, int glyph)
+{
+    return (glyph == COUNTDOWN_COLON) ? cw->colon_w : cw->digit_w;
+}
+
+// Screen area a cell repaints: the inked rows when blitting from the atlas,
+// the whole line box when drawing text
+static void countdown_cell_area(const countdown_widget_t *cw, const lv_obj_t *obj, int cell, lv_area_t *area)
+{
+    lv_obj_get_coords(obj, area);
+    area->x1 += cw->cell_x[cell];
+    area->x2 = area->x1 + countdown_glyph_w(cw, cw->glyph[cell]) - 1;
+    if (cw->atlas != NULL)
+    {
+        area->y1 += cw->ink_y;
+        area->y2 = area->y1 + cw->ink_h - 1;
+    }
+}
+
+static void countdown_measure(countdown_widget_t *cw)
+{
+    const lv_font_t *font = cw->font;
+    const int32_t line_h = lv_font_get_line_height(font);
+    int32_t top = line_h;
+    int32_t bottom = 0;
+
+    for (int i = 0; i < COUNTDOWN_GLYPHS; i++)
+    {
+        const uint32_t letter = (uint8_t)s_glyph_text[i][0];
+        lv_font_glyph_dsc_t g;
+
+        if (!lv_font_get_glyph_dsc(font, &g, letter, 0))
+        {
+            continue;
+        }
+
+        // Same placement as LVGL's label renderer
+        const int32_t y = (line_h - font->base_line) - g.box_h - g.ofs_y;
+        top = LV_MIN(top, y);
+        bottom = LV_MAX(bottom, y + g.box_h);
+
+        const int32_t w = lv_font_get_glyph_width(font, letter, 0);
+        if (i == COUNTDOWN_COLON)
+        {
+            cw->colon_w = w;
+        }
+        else
+        {
+            cw->digit_w = LV_MAX(cw->digit_w, w);
+        }
+    }
+
+    cw->ink_y = LV_MAX(top, 0);
+    cw->ink_h = LV_MIN(bottom, line_h) - cw->ink_y;
+
+    for (int cell = 0, x = 0; cell < COUNTDOWN_CELLS; cell++)
+    {
+        cw->cell_x[cell] = x;
+        x += (cell == 2) ? cw->colon_w : cw->digit_w;
+    }
+}
+
+// Render every glyph once through a throwaway canvas into the atlas
+static bool countdown_atlas_build(countdown_widget_t *cw, lv_obj_t *parent, lv_color_t bg_color)
+{
+    const int32_t atlas_w = 10 * cw->digit_w + cw->colon_w;
+    const uint32_t stride = lv_draw_buf_width_to_stride(atlas_w, LV_COLOR_FORMAT_RGB565);
+    const uint32_t size = stride * cw->ink_h;
+
+    cw->atlas = malloc(size);
+    if (cw->atlas == NULL)
+    {
+        ESP_LOGW(TAG, "No memory for the %u byte glyph atlas, drawing digits as text", (unsigned)size);
+        return false;
+    }
+
+    lv_draw_buf_t buf;
+    lv_draw_buf_init(&buf, atlas_w, cw->ink_h, LV_COLOR_FORMAT_RGB565, stride, cw->atlas, size);
+
+    lv_obj_t *canvas = lv_canvas_create(parent);
+    lv_obj_add_flag(canvas, LV_OBJ_FLAG_HIDDEN);
+    lv_canvas_set_draw_buf(canvas, &buf);
+    lv_canvas_fill_bg(canvas, bg_color, LV_OPA_COVER);
+
+    lv_layer_t layer;
+    lv_canvas_init_layer(canvas, &layer);
+
+    lv_draw_label_dsc_t dsc;
+    lv_draw_label_dsc_init(&dsc);
+    dsc.font = cw->font;
+    dsc.color = cw->color;
+    dsc.align = LV_TEXT_ALIGN_CENTER;
+
+    for (int i = 0, x = 0; i < COUNTDOWN_GLYPHS; i++)
+    {
+        const int32_t w = countdown_glyph_w(cw, i);
+        const lv_area_t area = {
+            .x1 = x,
+            .y1 = -cw->ink_y,
+            .x2 = x + w - 1,
+            .y2 = -cw->ink_y + lv_font_get_line_height(cw->font) - 1,
+        };
+
+        dsc.text = s_glyph_text[i];
+        lv_draw_label(&layer, &dsc, &area);
+
+        lv_image_dsc_t *img = &cw->glyph_img[i];
+        img->header.magic = LV_IMAGE_HEADER_MAGIC;
+        img->header.cf = LV_COLOR_FORMAT_RGB565;
+        img->header.w = w;
+        img->header.h = cw->ink_h;
+        img->header.stride = stride;
+        img->data = cw->atlas + x * sizeof(uint16_t);
+        img->data_size = stride * (cw->ink_h - 1) + w * sizeof(uint16_t);
+
+        x += w;
+    }
+
+    lv_canvas_finish_layer(canvas, &layer);
+    lv_obj_delete(canvas);
+
+    ESP_LOGI(TAG, "Glyph atlas %dx%d RGB565, %u bytes, cells %dx%d", (int)atlas_w, (int)cw->ink_h,
+             (unsigned)size, (int)cw->digit_w, (int)cw->ink_h);
+
+    return true;
+}
+
+static void countdown_event_cb(lv_event_t *e)
+{
+    lv_obj_t *obj = lv_event_get_current_target(e);
+    countdown_widget_t *cw = lv_obj_get_user_data(obj);
+
+    if (lv_event_get_code(e) == LV_EVENT_DELETE)
+    {
+        free(cw->atlas);
+        free(cw);
+        return;
+    }
+
+    lv_layer_t *layer = lv_event_get_layer(e);
+
+    for (int cell = 0; cell < COUNTDOWN_CELLS; cell++)
+    {
+        const int glyph = cw->glyph[cell];
+        lv_area_t area;
+
+        countdown_cell_area(cw, obj, cell, &area);
+
+        if (cw->atlas != NULL)
+        {
+            lv_draw_image_dsc_t dsc;
+            lv_draw_image_dsc_init(&dsc);
+            dsc.src = &cw->glyph_img[glyph];
+            lv_draw_image(layer, &dsc, &area);
+        }
+        else
+        {
+            lv_draw_label_dsc_t dsc;
+            lv_draw_label_dsc_init(&dsc);
+            dsc.font = cw->font;
+            dsc.color = cw->color;
+            dsc.align = LV_TEXT_ALIGN_CENTER;
+            dsc.text = s_glyph_text[glyph];
+            lv_draw_label(layer, &dsc, &area);
+        }
+    }
+}
+
+lv_obj_t *countdown_widget_create(lv_obj_t *parent, const lv_font_t *font, lv_color_t color, lv_color_t bg_color)
+{
+    countdown_widget_t *cw = calloc(1, sizeof(*cw));
+    if (cw == NULL)
+    {
+        return NULL;
+    }
+
+    cw->font = font;
+    cw->color = color;
+    countdown_measure(cw);
+    countdown_atlas_build(cw, parent, bg_color);
+
+    lv_obj_t *obj = lv_obj_create(parent);
+    lv_obj_remove_style_all(obj);
+    lv_obj_remove_flag(obj, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_size(obj, 4 * cw->digit_w + cw->colon_w, lv_font_get_line_height(font));
+    lv_obj_set_user_data(obj, cw);
+    lv_obj_add_event_cb(obj, countdown_event_cb, LV_EVENT_DRAW_MAIN, NULL);
+    lv_obj_add_event_cb(obj, countdown_event_cb, LV_EVENT_DELETE, NULL);
+
+    cw->glyph[2] = COUNTDOWN_COLON;
+
+    return obj;
+}
+
+void countdown_widget_set(lv_obj_t *obj, int seconds)
+{
+    countdown_widget_t *cw = lv_obj_get_user_data(obj);
+    uint8_t glyph[COUNTDOWN_CELLS];
+
+    seconds = LV_CLAMP(0, seconds, 99 * 60 + 59);
+    glyph[0] = seconds / 600;
+    glyph[1] = (seconds / 60) % 10;
+    glyph[2] = COUNTDOWN_COLON;
+    glyph[3] = (seconds % 60) / 10;
+    glyph[4] = seconds % 10;
+
+    for (int cell = 0; cell < COUNTDOWN_CELLS; cell++)
+    {
+        if (glyph[cell] == cw->glyph[cell])
+        {
+            continue;
+        }
+
+        cw->glyph[cell] = glyph[cell];
+
+        lv_area_t area;
+        countdown_cell_area(cw, obj, cell, &area);
+        lv_obj_invalidate_area(obj, &area);
+    }
+}
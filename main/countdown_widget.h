@@ -0,0 +1,15 @@
+#pragma once
+
+#include <lvgl.h>
+
+// "MM:SS" countdown display. The glyphs 0-9 and ':' are rendered once into an
+// RGB565 atlas (pre-blended over bg_color) and blitted per cell; setting a new
+// value only invalidates the cells whose character changed, so a typical tick
+// flushes one digit instead of the whole label. If the atlas cannot be
+// allocated the cells are drawn as text, still invalidated per cell.
+
+// Create the widget, sized to fit "MM:SS" in font
+lv_obj_t *countdown_widget_create(lv_obj_t *parent, const lv_font_t *font, lv_color_t color, lv_color_t bg_color);
+
+// Show seconds as MM:SS, clamped to 0..99:59
+void countdown_widget_set(lv_obj_t *obj, int seconds);
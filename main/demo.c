@@ -11,168 +11,145 @@
 #include <esp_log.h>
 #include <esp_err.h>
 #include <esp_check.h>
+#include <esp_timer.h>
 #include <esp_wifi.h>  // Added for WiFi functions
 #include <nvs_flash.h> // Added for NVS
 
 #include <lvgl.h>
-#include <esp_lvgl_port.h>
 
+#include "countdown_widget.h"
+#include "hardware.h"
 #include "lcd.h"
 #include "touch.h"
 #include "mqtt_relay_client.h"
+#include "splash.h"
+#include "static_cache.h"
+#include "wifi_widget.h"
 
 static const char *TAG = "water_control";
+
+// Generated from main/images and main/fonts.txt at build time
+LV_IMAGE_DECLARE(img_splash);
+LV_IMAGE_DECLARE(img_water_drop);
+LV_FONT_DECLARE(font_timer_48);
+
 // UI objects
 static lv_obj_t *toggle_btn;
 static lv_obj_t *btn_label;
-static lv_obj_t *timer_label;
+static lv_obj_t *timer_display;
+static lv_obj_t *water_icon;
 static lv_timer_t *countdown_timer = NULL;
 
 // WiFi status UI elements
-static lv_obj_t *wifi_panel;
-static lv_obj_t *wifi_ssid_label;
-static lv_obj_t *wifi_strength_bars[4]; // 4 bars for signal strength
+static lv_obj_t *wifi_status;
 static lv_timer_t *wifi_update_timer = NULL;
 
-// Timer variables
-static int seconds_remaining = 300; // 5 minutes = 300 seconds
-static bool timer_running = false;
+// Shared styles, set up once in ui_styles_init(). Objects reference them
+// instead of carrying their own local style.
+static lv_style_t style_screen;
+static lv_style_t style_btn;          // Valve off
+static lv_style_t style_btn_checked;  // Valve on
+static lv_style_t style_text;
+
+// UI state. Widgets are bound to these subjects and redraw themselves when
+// a value changes; everything else only sets the subjects (ui_subject_set).
+#define VALVE_RUN_SECONDS 300 // 5 minutes
+static lv_subject_t valve_subject;      // 1 while the water is on
+static lv_subject_t remaining_subject;  // Seconds left on the countdown
+static lv_subject_t rssi_subject;       // Signal bars, 0 to WIFI_WIDGET_BARS
 
 // Forward declarations
-static void toggle_event_cb(lv_event_t *e);
 static void countdown_timer_cb(lv_timer_t *timer);
-static void update_timer_display();
-static void start_countdown();
-static void stop_countdown();
 static void create_wifi_status_panel(lv_obj_t *parent);
 static void update_wifi_status();
 static void wifi_update_timer_cb(lv_timer_t *timer);
 
-// Event handler for toggle button
-static void toggle_event_cb(lv_event_t *e) {
-    lv_event_code_t code = lv_event_get_code(e);
-    lv_obj_t *obj = lv_event_get_target(e);
-    
-    if (code == LV_EVENT_VALUE_CHANGED) {
-        bool is_checked = lv_obj_has_state(obj, LV_STATE_CHECKED);
-        
-        if (is_checked) {
-            // Button toggled ON - start timer
-            ESP_LOGI(TAG, "Water turned ON");
-            
-            // Change button label to "Turn Water Off"
-            lv_label_set_text(btn_label, "Turn Water Off");
-            
-            // Set relay 1 ON via MQTT
-            mqtt_publish_relay_state(1, true);
-            
-            // Start the countdown
-            start_countdown();
-        } else {
-            // Button toggled OFF - stop timer
-            ESP_LOGI(TAG, "Water turned OFF");
-            
-            // Change button label back to "Turn Water On"
-            lv_label_set_text(btn_label, "Turn Water On");
-            
-            // Set relay 1 OFF via MQTT
-            mqtt_publish_relay_state(1, false);
-            
-            // Stop the countdown
-            stop_countdown();
-        }
+static void ui_styles_init(void) {
+    lv_style_init(&style_screen);
+    lv_style_set_bg_color(&style_screen, lv_color_black());
+
+    // Text colour is inherited, so the button label follows the button's state
+    lv_style_init(&style_btn);
+    lv_style_set_bg_color(&style_btn, lv_color_hex(0x0000FF));
+    lv_style_set_text_color(&style_btn, lv_color_white());
+
+    lv_style_init(&style_btn_checked);
+    lv_style_set_bg_color(&style_btn_checked, lv_color_hex(0xFF0000));
+    lv_style_set_text_color(&style_btn_checked, lv_color_black());
+
+    lv_style_init(&style_text);
+    lv_style_set_text_color(&style_text, lv_color_white());
+}
+
+// Set an int subject, notifying its observers only if the value changes
+static void ui_subject_set(lv_subject_t *subject, int32_t value) {
+    if (lv_subject_get_int(subject) != value) {
+        lv_subject_set_int(subject, value);
     }
 }
 
-// Timer callback function
-static void countdown_timer_cb(lv_timer_t *timer) {
-    if (!timer_running) return;
+// The one place valve changes land, whether they come from the button, MQTT
+// or the countdown running out: relay, countdown and MQTT state follow here
+static void valve_observer_cb(lv_observer_t *observer, lv_subject_t *subject) {
+    bool on = lv_subject_get_int(subject) != 0;
     
-    seconds_remaining--;
-    update_timer_display();
+    // Also called once when added, before anything has changed
+    if (lv_subject_get_previous_int(subject) == lv_subject_get_int(subject)) {
+        return;
+    }
     
-    if (seconds_remaining <= 0) {
-        // Time's up - turn off the water
-        ESP_LOGI(TAG, "Timer expired, turning water OFF");
-        
-        if (lvgl_port_lock(0)) {
-            lv_obj_clear_state(toggle_btn, LV_STATE_CHECKED);
-            // Also update the button label when timer expires
-            lv_label_set_text(btn_label, "Turn Water On");
-            lvgl_port_unlock();
+    ESP_LOGI(TAG, "Water turned %s", on ? "ON" : "OFF");
+    
+    ui_subject_set(&remaining_subject, VALVE_RUN_SECONDS);
+    if (on) {
+        if (countdown_timer == NULL) {
+            countdown_timer = lv_timer_create(countdown_timer_cb, 1000, NULL);
+        } else {
+            lv_timer_reset(countdown_timer);
+            lv_timer_resume(countdown_timer);
         }
-        
-        // Set relay 1 OFF via MQTT
-        mqtt_publish_relay_state(1, false);
-        
-        // Stop the timer
-        stop_countdown();
+    } else if (countdown_timer != NULL) {
+        lv_timer_pause(countdown_timer);
     }
+    
+    mqtt_publish_relay_state(1, on);
 }
 
-// Update the timer display
-static void update_timer_display() {
-    char time_str[16];
-    int minutes = seconds_remaining / 60;
-    int seconds = seconds_remaining % 60;
-    
-    sprintf(time_str, "%02d:%02d", minutes, seconds);
-    
-    if (lvgl_port_lock(0)) {
-        lv_label_set_text(timer_label, time_str);
-        lvgl_port_unlock();
-    }
+static void btn_label_observer_cb(lv_observer_t *observer, lv_subject_t *subject) {
+    lv_obj_t *label = lv_observer_get_target_obj(observer);
+    lv_label_set_text(label, lv_subject_get_int(subject) ? "Turn Water Off" : "Turn Water On");
 }
 
-// Start the countdown timer
-static void start_countdown() {
-    seconds_remaining = 300; // Reset to 5 minutes
-    timer_running = true;
-    
-    update_timer_display();
-    
-    if (countdown_timer == NULL) {
-        countdown_timer = lv_timer_create(countdown_timer_cb, 1000, NULL);
-    } else {
-        lv_timer_resume(countdown_timer);
-    }
+static void timer_display_observer_cb(lv_observer_t *observer, lv_subject_t *subject) {
+    // Only the digits that changed are invalidated
+    countdown_widget_set(lv_observer_get_target_obj(observer), lv_subject_get_int(subject));
 }
 
-// Stop the countdown timer
-static void stop_countdown() {
-    timer_running = false;
-    seconds_remaining = 300; // Reset to 5 minutes
+static void wifi_bars_observer_cb(lv_observer_t *observer, lv_subject_t *subject) {
+    wifi_widget_set_bars(lv_observer_get_target_obj(observer), lv_subject_get_int(subject));
+}
+
+// Timer callback function, runs in the LVGL task while the valve is on
+static void countdown_timer_cb(lv_timer_t *timer) {
+    int32_t remaining = lv_subject_get_int(&remaining_subject) - 1;
     
-    if (countdown_timer != NULL) {
-        lv_timer_pause(countdown_timer);
+    if (remaining <= 0) {
+        // Time's up - turn off the water
+        ESP_LOGI(TAG, "Timer expired, turning water OFF");
+        ui_subject_set(&valve_subject, 0);
+        return;
     }
     
-    update_timer_display();
+    ui_subject_set(&remaining_subject, remaining);
 }
 
-// Create WiFi status panel at the bottom left
+// Create the WiFi status indicator at the bottom left
 static void create_wifi_status_panel(lv_obj_t *parent) {
-    // Create a panel for WiFi status info
-    wifi_panel = lv_obj_create(parent);
-    lv_obj_remove_style_all(wifi_panel);
-    lv_obj_set_size(wifi_panel, 170, 60);
-    lv_obj_align(wifi_panel, LV_ALIGN_BOTTOM_LEFT, 10, -10);
-    
-    // Create SSID label
-    wifi_ssid_label = lv_label_create(wifi_panel);
-    lv_obj_set_style_text_color(wifi_ssid_label, lv_color_white(), LV_PART_MAIN);
-    lv_label_set_text(wifi_ssid_label, "WiFi: ---");
-    lv_obj_align(wifi_ssid_label, LV_ALIGN_TOP_LEFT, 0, 0);
-    
-    // Create signal strength bars
-    for (int i = 0; i < 4; i++) {
-        wifi_strength_bars[i] = lv_obj_create(wifi_panel);
-        lv_obj_set_size(wifi_strength_bars[i], 8, 5 + (i+1) * 3);
-        lv_obj_align(wifi_strength_bars[i], LV_ALIGN_BOTTOM_LEFT, 10 + i*12, 0);
-        lv_obj_set_style_bg_color(wifi_strength_bars[i], lv_color_hex(0x888888), LV_PART_MAIN); // Gray (inactive)
-        lv_obj_set_style_border_width(wifi_strength_bars[i], 0, LV_PART_MAIN);
-        lv_obj_set_style_radius(wifi_strength_bars[i], 1, LV_PART_MAIN);
-    }
+    // SSID and signal bars drawn by one object (wifi_widget.h)
+    wifi_status = wifi_widget_create(parent);
+    lv_obj_add_style(wifi_status, &style_text, LV_PART_MAIN);
+    lv_obj_align(wifi_status, LV_ALIGN_BOTTOM_LEFT, 10, -10);
+    lv_subject_add_observer_obj(&rssi_subject, wifi_bars_observer_cb, wifi_status, NULL);
     
     // Start periodic updates
     wifi_update_timer = lv_timer_create(wifi_update_timer_cb, 5000, NULL); // Update every 5 seconds
@@ -183,65 +160,26 @@ static void create_wifi_status_panel(lv_obj_t *parent) {
 
 // Update WiFi status information
 static void update_wifi_status() {
-    if (!lvgl_port_lock(0)) {
+    if (!app_lvgl_lock(0)) {
         return;
     }
     
     // Get WiFi status
     wifi_ap_record_t ap_info;
-    bool is_connected = false;
-    int8_t rssi = -100; // Default poor signal
-    char ssid[33] = {0}; // Max SSID length is 32 bytes + null terminator
     
+    // The widget only redraws the text when it actually changes, the bars
+    // follow rssi_subject
     if (esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK) {
-        is_connected = true;
-        rssi = ap_info.rssi;
+        char ssid[33] = {0}; // Max SSID length is 32 bytes + null terminator
         memcpy(ssid, (char *)ap_info.ssid, sizeof(ap_info.ssid));
-    }
-    
-    // Update SSID label
-    if (is_connected) {
-        char ssid_text[50];
-        snprintf(ssid_text, sizeof(ssid_text), "WiFi: %s", ssid);
-        lv_label_set_text(wifi_ssid_label, ssid_text);
+        wifi_widget_set_ssid(wifi_status, ssid);
+        ui_subject_set(&rssi_subject, wifi_widget_bars_from_rssi(ap_info.rssi));
     } else {
-        lv_label_set_text(wifi_ssid_label, "WiFi: Not Connected");
+        wifi_widget_set_ssid(wifi_status, NULL);
+        ui_subject_set(&rssi_subject, 0);
     }
     
-    // Update signal strength bars
-    if (is_connected) {
-        // RSSI ranges typically from -30 (excellent) to -90 (unusable)
-        // Convert to 0-4 bars
-        int bars = 0;
-        if (rssi >= -55) bars = 4;      // Excellent: -55 to -30 dBm
-        else if (rssi >= -67) bars = 3; // Good: -67 to -56 dBm
-        else if (rssi >= -77) bars = 2; // Fair: -77 to -68 dBm
-        else if (rssi >= -87) bars = 1; // Poor: -87 to -78 dBm
-                                        // No bars: < -88 dBm
-        
-        for (int i = 0; i < 4; i++) {
-            // Set color based on active status
-            if (i < bars) {
-                // Active bars - green to yellow based on strength
-                if (bars >= 3) {
-                    lv_obj_set_style_bg_color(wifi_strength_bars[i], lv_color_hex(0x00FF00), LV_PART_MAIN); // Green for good signal
-                } else if (bars >= 2) {
-                    lv_obj_set_style_bg_color(wifi_strength_bars[i], lv_color_hex(0xFFFF00), LV_PART_MAIN); // Yellow for medium signal
-                } else {
-                    lv_obj_set_style_bg_color(wifi_strength_bars[i], lv_color_hex(0xFF8800), LV_PART_MAIN); // Orange for weak signal
-                }
-            } else {
-                lv_obj_set_style_bg_color(wifi_strength_bars[i], lv_color_hex(0x888888), LV_PART_MAIN); // Gray for inactive
-            }
-        }
-    } else {
-        // No connection - all bars gray
-        for (int i = 0; i < 4; i++) {
-            lv_obj_set_style_bg_color(wifi_strength_bars[i], lv_color_hex(0x888888), LV_PART_MAIN);
-        }
-    }
-    
-    lvgl_port_unlock();
+    app_lvgl_unlock();
 }
 
 // WiFi status update timer callback
@@ -250,7 +188,7 @@ static void wifi_update_timer_cb(lv_timer_t *timer) {
 }
 
 static esp_err_t app_lvgl_main(void) {
-    lvgl_port_lock(0);
+    app_lvgl_lock(0);
     
     // Get active screen with NULL check
     lv_obj_t *scr = lv_scr_act();
@@ -260,9 +198,14 @@ static esp_err_t app_lvgl_main(void) {
         lv_scr_load(scr);
     }
     
+    ui_styles_init();
+    
+    lv_subject_init_int(&valve_subject, 0);
+    lv_subject_init_int(&remaining_subject, VALVE_RUN_SECONDS);
+    lv_subject_init_int(&rssi_subject, 0);
+    
     // Clear screen - set background to black
-    lv_obj_set_style_bg_color(scr, lv_color_black(), LV_PART_MAIN);
-    //lv_obj_set_style_bg_color(scr, lv_color_hex(0x2222FF), LV_PART_MAIN); // Blue background
+    lv_obj_add_style(scr, &style_screen, LV_PART_MAIN);
 
     // Create toggle button
     toggle_btn = lv_btn_create(scr);
@@ -270,32 +213,43 @@ static esp_err_t app_lvgl_main(void) {
     lv_obj_set_size(toggle_btn, 160, 60);
     lv_obj_align(toggle_btn, LV_ALIGN_TOP_LEFT, 10, 10);
     
-    // Set button styles for both states
-    lv_obj_set_style_bg_color(toggle_btn, lv_color_hex(0x0000FF), LV_PART_MAIN); // Blue background for OFF state
-    lv_obj_set_style_bg_color(toggle_btn, lv_color_hex(0xFF0000), LV_STATE_CHECKED); // Red background for ON state
+    // Blue with white text when off, red with black text when on
+    lv_obj_add_style(toggle_btn, &style_btn, LV_PART_MAIN);
+    lv_obj_add_style(toggle_btn, &style_btn_checked, LV_STATE_CHECKED);
     
-    // Create label on the button
+    // Checked state and valve_subject follow each other both ways
+    lv_obj_bind_checked(toggle_btn, &valve_subject);
+    
+    // Create label on the button, its text set by the observer
     btn_label = lv_label_create(toggle_btn);
-    lv_label_set_text(btn_label, "Turn Water On");
-    lv_obj_set_style_text_color(btn_label, lv_color_white(), LV_PART_MAIN); // White text for OFF state
-    lv_obj_set_style_text_color(btn_label, lv_color_black(), LV_STATE_CHECKED); // Black text for ON state
+    lv_subject_add_observer_obj(&valve_subject, btn_label_observer_cb, btn_label, NULL);
     lv_obj_center(btn_label);
     
-    // Add event handler for the toggle button
-    lv_obj_add_event_cb(toggle_btn, toggle_event_cb, LV_EVENT_VALUE_CHANGED, NULL);
+    // Create the timer display, digits blitted from a pre-rendered atlas
+    timer_display = countdown_widget_create(scr, &font_timer_48, lv_color_white(), lv_color_black());
+    lv_obj_align(timer_display, LV_ALIGN_CENTER, 0, 0);
+    lv_subject_add_observer_obj(&remaining_subject, timer_display_observer_cb, timer_display, NULL);
+    
+    // Valve indicator, a compressed image from main/images (see img_rle565.h),
+    // shown while the valve is open
+    water_icon = lv_image_create(scr);
+    lv_image_set_src(water_icon, &img_water_drop);
+    lv_obj_align(water_icon, LV_ALIGN_TOP_RIGHT, -20, 24);
+    lv_obj_bind_flag_if_eq(water_icon, &valve_subject, LV_OBJ_FLAG_HIDDEN, 0);
     
-    // Create the timer display label (with doubled size)
-    timer_label = lv_label_create(scr);
-    lv_obj_set_style_text_font(timer_label, &lv_font_montserrat_48, LV_PART_MAIN); // Largest standard font
-    lv_obj_set_style_text_color(timer_label, lv_color_white(), LV_PART_MAIN);
-    // No transform scaling
-    lv_obj_align(timer_label, LV_ALIGN_CENTER, 0, 0);
-    lv_label_set_text(timer_label, "05:00");
+    // Added last, so the widgets bound above are up to date when it runs
+    lv_subject_add_observer(&valve_subject, valve_observer_cb, NULL);
     
     // Create WiFi status panel
     create_wifi_status_panel(scr);
+
+#if LCD_STATIC_CACHE
+    // Redrawn from snapshots until their state or styles change. The WiFi
+    // indicator is a single object, drawn live as cheaply as from a snapshot.
+    static_cache_add(toggle_btn);
+#endif
     
-    lvgl_port_unlock();
+    app_lvgl_unlock();
     
     return ESP_OK;
 }
@@ -305,28 +259,15 @@ static void mqtt_state_callback(uint8_t relay_num, bool state) {
     ESP_LOGI(TAG, "Received MQTT state change: relay %d -> %s", 
              relay_num, state ? "ON" : "OFF");
     
-    // Update UI to match the MQTT state
-    if (lvgl_port_lock(0)) {
-        if (state) {
-            // Turn ON
-            lv_obj_add_state(toggle_btn, LV_STATE_CHECKED);
-            lv_label_set_text(btn_label, "Turn Water Off");
-            
-            // Start countdown if not running
-            if (!timer_running) {
-                start_countdown();
-            }
+    // The bound widgets and valve_observer_cb() do the rest, if the state
+    // changed. A command for the current state is still confirmed.
+    if (app_lvgl_lock(0)) {
+        if (lv_subject_get_int(&valve_subject) == state) {
+            mqtt_publish_relay_state(relay_num, state);
         } else {
-            // Turn OFF
-            lv_obj_clear_state(toggle_btn, LV_STATE_CHECKED);
-            lv_label_set_text(btn_label, "Turn Water On");
-            
-            // Stop countdown if running
-            if (timer_running) {
-                stop_countdown();
-            }
+            ui_subject_set(&valve_subject, state);
         }
-        lvgl_port_unlock();
+        app_lvgl_unlock();
     }
 }
 
@@ -349,25 +290,37 @@ void app_main(void) {
     // Initialize backlight control but keep it OFF initially
     ESP_ERROR_CHECK(lcd_display_brightness_init());
     
-    // Initialize LVGL
+    // Show the splash straight from the panel driver and light the screen now,
+    // rather than after WiFi has connected
+    bool splash_on = splash_show(lcd_panel, &img_splash, lv_color_black()) == ESP_OK;
+    if (splash_on) {
+        ESP_ERROR_CHECK(lcd_display_brightness_set(100));
+        ESP_LOGI(LCD_TAG, "First pixel on screen %lld ms after boot", (long long)(esp_timer_get_time() / 1000));
+    }
+    
+    // Initialize LVGL, which draws nothing until app_lvgl_show()
     lv_display_t *disp = app_lvgl_init(lcd_io, lcd_panel);
     
+    // Build the UI while the splash is showing (backlight still off if it failed)
+    ESP_ERROR_CHECK(app_lvgl_main());
+    
+    // The UI's first frame replaces the splash, before WiFi is waited for
+    app_lvgl_show(disp);
+    ESP_LOGI(LCD_TAG, "UI on screen %lld ms after boot", (long long)(esp_timer_get_time() / 1000));
+    
+    if (!splash_on) {
+        // Panel RAM still holds power-on garbage until the first frame is out
+        vTaskDelay(pdMS_TO_TICKS(50));
+        ESP_LOGI(LCD_TAG, "Turning on backlight to 100%%");
+        ESP_ERROR_CHECK(lcd_display_brightness_set(100));
+    }
+    
     // Initialize touch
     esp_lcd_touch_handle_t tp = NULL;
     ESP_ERROR_CHECK(app_touch_init(&tp));
+    app_lvgl_add_touch(disp, tp);
     
-    // Initialize MQTT client
+    // Initialize MQTT client; the UI publishes nothing until it has connected
     mqtt_init();
     mqtt_register_state_change_callback(mqtt_state_callback);
-    
-    // Initialize LVGL UI (with display still off)
-    ESP_ERROR_CHECK(app_lvgl_main());
-    
-    // Force a display refresh to ensure UI is fully drawn before turning on backlight
-    lv_timer_handler();
-    vTaskDelay(pdMS_TO_TICKS(50));
-    
-    // Now turn on the backlight at full brightness
-    ESP_LOGI(LCD_TAG, "Turning on backlight to 100%");
-    ESP_ERROR_CHECK(lcd_display_brightness_set(100));
 }
@@ -3,15 +3,46 @@
 #define LCD_H_RES          240
 #define LCD_V_RES          320
 #define LCD_BITS_PIXEL     16
-#define LCD_BUF_LINES      30
+#define LCD_BUF_LINES      30  /* Minimum band height; taller bands are picked at boot when DMA heap allows */
+#define LCD_BUF_LINES_MAX  LCD_V_RES
+#define LCD_DMA_HEAP_RESERVE (64 * 1024)  /* DMA-capable heap left for WiFi/MQTT after the draw buffers */
 #define LCD_DOUBLE_BUFFER  1
 #define LCD_DRAWBUF_SIZE   (LCD_H_RES * LCD_BUF_LINES)
+#define LCD_DIRECT_MODE    1   /* One full frame and only dirty rows sent, when the DMA heap has room for it beside LCD_DMA_HEAP_RESERVE; bands otherwise */
+#define LCD_RENDER_SWAPPED 1   /* Let LVGL render big-endian RGB565 instead of swapping bytes at flush, when supported */
+#define LCD_PIPELINED_FLUSH 1  /* Render band N+1 while band N is on the SPI bus, needs LCD_DOUBLE_BUFFER */
+#define LCD_STATS_LOG_PERIOD_MS  0   /* Dump flush histograms to the log every N ms, 0 = off */
+#define LVGL_TASK_PRIORITY 4
+#define LCD_REFR_GOVERNOR  1   /* Adapt the refresh period to input/animation activity (lcd_refresh.c) */
+#define LCD_REFR_PERIOD_FAST_MS  16   /* While touched, scrolling or animating */
+#define LCD_REFR_PERIOD_IDLE_MS  200  /* When only lv_timers (countdown, WiFi bars) change the screen */
+#define LCD_REFR_HOLD_MS   500  /* Stay fast this long after the last input or animation */
+#define LCD_SOLID_FILL     1   /* Send band strips that are one flat colour as fills, without rendering them (lcd_solid.c) */
+#define LCD_SOLID_FILL_LINES 8  /* Rows in the repeated fill buffer; each chunk is one SPI transaction */
+#define LCD_FLUSH_HASH     1   /* Skip or trim flushes whose pixels are already on the panel (lcd_hash.c) */
+#define LCD_HASH_ENTRIES   16  /* Flushed areas remembered */
+#define LCD_HASH_STRIP_ROWS 8  /* Rows per hash, the trimming granularity */
+#define LCD_MERGE_COST_MODEL 1  /* Merge dirty areas into their bounding box when that is cheaper on the SPI bus (lcd_merge.c) */
+#define LCD_THEME_LEAN     1   /* Default theme without rounded corners, shadows, press grow or transitions (lcd_theme.c); lcd_theme_set_lean() switches at runtime */
+#define LCD_STATIC_CACHE   1   /* Draw rarely changing subtrees from RGB565 snapshots (static_cache.c) */
+#define LCD_STATIC_CACHE_BUDGET (48 * 1024)  /* Heap for snapshots; subtrees that do not fit are drawn live */
+#define LCD_STATIC_CACHE_SETTLE_MS 1000      /* Re-snapshot a changed subtree after this long without changes */
+#define LCD_IDLE_SLEEP     1   /* Backlight off, panel SLPIN and no LVGL refresh after LCD_IDLE_TIMEOUT_MS without touch (lcd_idle.c) */
+#define LCD_IDLE_TIMEOUT_MS (2 * 60 * 1000)
+#define LCD_IDLE_POLL_MS   100  /* Touch polling period while asleep, when TOUCH_IRQ is not connected */
+#define LVGL_MEM_SCRATCH_SIZE (16 * 1024)  /* Arena for LVGL allocations made while rendering, with LV_STDLIB_CUSTOM in lv_conf.h (lvgl_mem.c) */
+#define LVGL_EVENT_DRIVEN  1   /* Own LVGL task that sleeps until invalidation, touch or a due lv_timer (lvgl_task.c) instead of esp_lvgl_port's 5 ms tick */
+#define LVGL_TASK_AFFINITY 1   /* Keep the LVGL task off the WiFi core (-1 = any); the LV_DRAW_SW_DRAW_UNIT_CNT draw tasks are unpinned and use both */
 
+#define LCD_SWAP_XY        (true)
 #define LCD_MIRROR_X       (false)
 #define LCD_MIRROR_Y       (true)
 
 
 #define LCD_PIXEL_CLOCK_HZ (40 * 1000 * 1000)
+#define LCD_READ_CLOCK_HZ  (6 * 1000 * 1000)   /* RAMRD is specified much slower than writes */
+#define LCD_PCLK_CALIBRATE 0   /* Pick the fastest verified pixel clock on first boot and keep it in NVS */
+#define LCD_PCLK_CALIBRATE_PASSES 3
 #define LCD_CMD_BITS       (8)
 #define LCD_PARAM_BITS     (8)
 #define LCD_SPI_HOST       SPI2_HOST
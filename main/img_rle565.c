@@ -0,0 +1,328 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <esp_log.h>
+#include <lvgl.h>
+#include <src/draw/lv_image_decoder_private.h>
+
+#include "img_rle565.h"
+
+static const char *TAG = "img_rle565";
+
+#define IMG_RLE565_HEADER_SIZE  12
+#define IMG_RLE565_VERSION      1
+#define IMG_RLE565_FLAG_ALPHA   0x01
+
+#define IMG_RLE565_OP_RUN       0x40
+#define IMG_RLE565_OP_LITERAL   0x80
+
+// Pixel as the encoder sees it: RGB565 in bits 0-15, alpha in bits 16-23
+#define IMG_RLE565_OPAQUE_BLACK 0xFF0000u
+
+typedef struct {
+    uint16_t *color;
+    uint8_t *alpha;
+    uint32_t color_stride;
+    uint32_t alpha_stride;
+    int32_t w;
+    int32_t x;
+    uint32_t skip;          // Pixels before the first requested row of the block
+    uint32_t left;          // Pixels still to write
+} img_rle565_out_t;
+
+typedef struct {
+    img_rle565_t img;
+    lv_draw_buf_t *band;    // block_rows full-width rows
+} img_rle565_ctx_t;
+
+static inline uint32_t img_rle565_rd16(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static inline uint32_t img_rle565_rd32(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint32_t img_rle565_hash(uint32_t px)
+{
+    const uint32_t r = (px >> 11) & 0x1F;
+    const uint32_t g = (px >> 5) & 0x3F;
+    const uint32_t b = px & 0x1F;
+
+    return (r * 3 + g * 5 + b * 7 + (px >> 16) * 11) & 63;
+}
+
+// Write n copies of px, dropping the pixels before the requested rows
+static void img_rle565_put(img_rle565_out_t *out, uint32_t px, uint32_t n)
+{
+    if (out->skip > 0)
+    {
+        const uint32_t k = LV_MIN(n, out->skip);
+        out->skip -= k;
+        n -= k;
+    }
+
+    n = LV_MIN(n, out->left);
+    out->left -= n;
+
+    while (n > 0)
+    {
+        const uint32_t k = LV_MIN(n, (uint32_t)(out->w - out->x));
+        uint16_t *dst = out->color + out->x;
+
+        for (uint32_t i = 0; i < k; i++)
+        {
+            dst[i] = (uint16_t)px;
+        }
+        if (out->alpha != NULL)
+        {
+            memset(out->alpha + out->x, (uint8_t)(px >> 16), k);
+        }
+
+        n -= k;
+        out->x += k;
+        if (out->x == out->w)
+        {
+            out->x = 0;
+            out->color = (uint16_t *)((uint8_t *)out->color + out->color_stride);
+            if (out->alpha != NULL)
+            {
+                out->alpha += out->alpha_stride;
+            }
+        }
+    }
+}
+
+static bool img_rle565_decode_block(const img_rle565_t *img, uint32_t block, img_rle565_out_t *out)
+{
+    const uint8_t *p = img->stream + img_rle565_rd32(img->offsets + 4 * block);
+    const uint8_t *end = (block + 1 < img->blocks) ? img->stream + img_rle565_rd32(img->offsets + 4 * (block + 1)) : img->end;
+    const uint32_t px_size = img->alpha ? 3 : 2;
+    uint32_t index[64] = { 0 };
+    uint32_t prev = IMG_RLE565_OPAQUE_BLACK;
+
+    while (out->left > 0 && p < end)
+    {
+        const uint8_t op = *p++;
+
+        if (op < IMG_RLE565_OP_RUN)
+        {
+            prev = index[op];
+            img_rle565_put(out, prev, 1);
+        }
+        else if (op < IMG_RLE565_OP_LITERAL)
+        {
+            img_rle565_put(out, prev, (op & 0x3F) + 1);
+        }
+        else
+        {
+            const uint32_t n = (op & 0x7F) + 1;
+
+            if (p + n * px_size > end)
+            {
+                return false;
+            }
+
+            for (uint32_t i = 0; i < n; i++, p += px_size)
+            {
+                prev = img_rle565_rd16(p) | (img->alpha ? (uint32_t)p[2] << 16 : IMG_RLE565_OPAQUE_BLACK);
+                index[img_rle565_hash(prev)] = prev;
+                img_rle565_put(out, prev, 1);
+            }
+        }
+    }
+
+    return out->left == 0;
+}
+
+bool img_rle565_parse(img_rle565_t *img, const uint8_t *data, uint32_t size)
+{
+    if (data == NULL || size < IMG_RLE565_HEADER_SIZE || memcmp(data, "R565", 4) != 0 ||
+        data[8] != IMG_RLE565_VERSION || data[10] == 0)
+    {
+        return false;
+    }
+
+    img->w = img_rle565_rd16(data + 4);
+    img->h = img_rle565_rd16(data + 6);
+    img->alpha = (data[9] & IMG_RLE565_FLAG_ALPHA) != 0;
+    img->block_rows = data[10];
+    img->blocks = (img->h + img->block_rows - 1) / img->block_rows;
+    img->offsets = data + IMG_RLE565_HEADER_SIZE;
+    img->stream = img->offsets + 4 * img->blocks;
+    img->end = data + size;
+
+    if (img->stream > img->end)
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < img->blocks; i++)
+    {
+        if (img_rle565_rd32(img->offsets + 4 * i) > (uint32_t)(img->end - img->stream))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool img_rle565_decode_rows(const img_rle565_t *img, int32_t y, int32_t rows,
+                            uint16_t *color, uint32_t color_stride, uint8_t *alpha, uint32_t alpha_stride)
+{
+    img_rle565_out_t out = {
+        .color = color,
+        .alpha = img->alpha ? alpha : NULL,
+        .color_stride = color_stride,
+        .alpha_stride = alpha_stride,
+        .w = img->w,
+    };
+
+    rows = LV_MIN(rows, img->h - y);
+
+    while (rows > 0)
+    {
+        const uint32_t block = y / img->block_rows;
+        const int32_t first = y % img->block_rows;
+        const int32_t n = LV_MIN(rows, img->block_rows - first);
+
+        out.skip = first * img->w;
+        out.left = n * img->w;
+        if (!img_rle565_decode_block(img, block, &out))
+        {
+            return false;
+        }
+
+        y += n;
+        rows -= n;
+    }
+
+    return true;
+}
+
+// Claim RAW images that start with our magic
+static bool img_rle565_src(const void *src, lv_image_src_t src_type, img_rle565_t *img)
+{
+    if (src_type != LV_IMAGE_SRC_VARIABLE)
+    {
+        return false;
+    }
+
+    const lv_image_dsc_t *dsc = src;
+    if (dsc->header.cf != LV_COLOR_FORMAT_RAW && dsc->header.cf != LV_COLOR_FORMAT_RAW_ALPHA)
+    {
+        return false;
+    }
+
+    return img_rle565_parse(img, dsc->data, dsc->data_size);
+}
+
+static lv_result_t img_rle565_info_cb(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc, lv_image_header_t *header)
+{
+    img_rle565_t img;
+
+    if (!img_rle565_src(dsc->src, dsc->src_type, &img))
+    {
+        return LV_RESULT_INVALID;
+    }
+
+    *header = ((const lv_image_dsc_t *)dsc->src)->header;
+    header->cf = img.alpha ? LV_COLOR_FORMAT_RGB565A8 : LV_COLOR_FORMAT_RGB565;
+    header->w = img.w;
+    header->h = img.h;
+    header->stride = lv_draw_buf_width_to_stride(img.w, header->cf);
+
+    return LV_RESULT_OK;
+}
+
+static lv_result_t img_rle565_open_cb(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc)
+{
+    img_rle565_ctx_t *ctx = lv_malloc_zeroed(sizeof(*ctx));
+    if (ctx == NULL)
+    {
+        return LV_RESULT_INVALID;
+    }
+
+    if (!img_rle565_src(dsc->src, dsc->src_type, &ctx->img))
+    {
+        lv_free(ctx);
+        return LV_RESULT_INVALID;
+    }
+
+    // No decoded image: the renderer pulls bands through get_area_cb
+    dsc->user_data = ctx;
+    dsc->decoded = NULL;
+
+    return LV_RESULT_OK;
+}
+
+static lv_result_t img_rle565_get_area_cb(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc,
+                                          const lv_area_t *full_area, lv_area_t *decoded_area)
+{
+    img_rle565_ctx_t *ctx = dsc->user_data;
+    const img_rle565_t *img = &ctx->img;
+
+    // First call: start at the top of the area, then continue below the last band
+    const int32_t y = (decoded_area->y1 == LV_COORD_MIN) ? full_area->y1 : decoded_area->y2 + 1;
+    if (y > full_area->y2)
+    {
+        return LV_RESULT_INVALID;
+    }
+
+    if (ctx->band == NULL)
+    {
+        ctx->band = lv_draw_buf_create(img->w, img->block_rows, dsc->header.cf, LV_STRIDE_AUTO);
+        if (ctx->band == NULL)
+        {
+            ESP_LOGW(TAG, "No memory for a %dx%d band", (int)img->w, (int)img->block_rows);
+            return LV_RESULT_INVALID;
+        }
+    }
+
+    // Up to the end of the block, so every band after the first decodes one whole block
+    const int32_t rows = LV_MIN(img->block_rows - y % img->block_rows, full_area->y2 - y + 1);
+    const uint32_t stride = ctx->band->header.stride;
+
+    // RGB565A8 keeps the alpha plane after the last row, so the band height must match
+    ctx->band->header.h = rows;
+    if (!img_rle565_decode_rows(img, y, rows, (uint16_t *)ctx->band->data, stride,
+                                ctx->band->data + stride * rows, stride / 2))
+    {
+        ESP_LOGW(TAG, "Corrupt image stream at row %d", (int)y);
+        return LV_RESULT_INVALID;
+    }
+
+    decoded_area->x1 = 0;
+    decoded_area->x2 = img->w - 1;
+    decoded_area->y1 = y;
+    decoded_area->y2 = y + rows - 1;
+    dsc->decoded = ctx->band;
+
+    return LV_RESULT_OK;
+}
+
+static void img_rle565_close_cb(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc)
+{
+    img_rle565_ctx_t *ctx = dsc->user_data;
+
+    if (ctx->band != NULL)
+    {
+        lv_draw_buf_destroy(ctx->band);
+    }
+    lv_free(ctx);
+}
+
+void img_rle565_decoder_init(void)
+{
+    lv_image_decoder_t *decoder = lv_image_decoder_create();
+
+    lv_image_decoder_set_info_cb(decoder, img_rle565_info_cb);
+    lv_image_decoder_set_open_cb(decoder, img_rle565_open_cb);
+    lv_image_decoder_set_get_area_cb(decoder, img_rle565_get_area_cb);
+    lv_image_decoder_set_close_cb(decoder, img_rle565_close_cb);
+
+    ESP_LOGI(TAG, "Compressed RGB565 image decoder registered");
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <lvgl.h>
+
+// Compressed RGB565 images produced by tools/img_rle565.py (see there for the
+// stream format). The build converts main/images/*.png into lv_image_dsc_t
+// img_<name>, usable anywhere LVGL takes an image source once the decoder is
+// registered.
+//
+// Images are decoded one band of rows at a time straight into a small draw
+// buffer for LVGL's software renderer, so the full-size RGB565 image never
+// exists in RAM. Only rows covering the area being redrawn are decoded,
+// starting from the nearest block boundary.
+
+typedef struct {
+    int32_t w;
+    int32_t h;
+    bool alpha;             // Pixels carry 8-bit alpha, decoded as RGB565A8
+    int32_t block_rows;     // Rows per independently decodable block
+    uint32_t blocks;
+    const uint8_t *offsets; // Little-endian u32 per block, relative to stream
+    const uint8_t *stream;
+    const uint8_t *end;
+} img_rle565_t;
+
+// Check the header of an encoded stream and fill img. Returns false if data is
+// not an img_rle565 stream or is truncated.
+bool img_rle565_parse(img_rle565_t *img, const uint8_t *data, uint32_t size);
+
+// Decode rows [y, y + rows) into color (RGB565, color_stride bytes per row)
+// and, for images with alpha, into alpha (A8, alpha_stride bytes per row;
+// may be NULL to drop it). Returns false if the stream ends early.
+bool img_rle565_decode_rows(const img_rle565_t *img, int32_t y, int32_t rows,
+                            uint16_t *color, uint32_t color_stride, uint8_t *alpha, uint32_t alpha_stride);
+
+// Register the LVGL image decoder, with LVGL locked
+void img_rle565_decoder_init(void);
@@ -14,6 +14,9 @@
 #include <esp_lcd_panel_vendor.h>
 #include <esp_lcd_panel_ops.h>
 #include <esp_timer.h>
+#include <esp_heap_caps.h>
+#include <esp_pm.h>
+#include <esp_sleep.h>
 #include <driver/gpio.h>
 #include <driver/ledc.h>
 #include <driver/spi_master.h>
@@ -25,6 +28,17 @@
 // Add this with your other includes
 #include "driver/ledc.h"
 #include "hardware.h"
+#include "img_rle565.h"
+#include "lcd_bus_cost.h"
+#include "lcd_clock.h"
+#include "lcd_flush.h"
+#include "lcd_idle.h"
+#include "lcd_merge.h"
+#include "lcd_solid.h"
+#include "lcd_refresh.h"
+#include "lcd_theme.h"
+#include "lvgl_mem.h"
+#include "lvgl_task.h"
 // At the top of the file, after other includes
 
 // LCD Backlight control configuration
@@ -33,6 +47,66 @@
 #define LCD_BACKLIGHT_LEDC_RESOLUTION  8  // 8-bit resolution (0-255)
 static const char *TAG="lcd";
 
+// Last brightness set, so the backlight can be restored after idle sleep
+static int s_brightness;
+
+// Band height chosen at boot by lcd_drawbuf_lines_from_heap()
+static int s_buf_lines = LCD_BUF_LINES;
+
+// Until app_lvgl_show() the refresh timer runs with a period that never
+// comes due, since invalidation would resume a paused one. Keeps LVGL's empty
+// default screen from replacing the splash before the UI is built.
+#define LCD_REFR_PARKED_MS  (24 * 60 * 60 * 1000)
+static uint32_t s_refr_period;
+
+// Pick the tallest band that fits the DMA-capable heap, keeping
+// LCD_DMA_HEAP_RESERVE free for WiFi/MQTT
+static int lcd_drawbuf_lines_from_heap(void)
+{
+    const uint32_t caps = MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL;
+    const int buffers = LCD_DOUBLE_BUFFER ? 2 : 1;
+    const size_t line_bytes = LCD_H_RES * sizeof(uint16_t);
+
+    size_t free_bytes = heap_caps_get_free_size(caps);
+    size_t largest = heap_caps_get_largest_free_block(caps);
+    size_t budget = (free_bytes > LCD_DMA_HEAP_RESERVE) ? (free_bytes - LCD_DMA_HEAP_RESERVE) / buffers : 0;
+    size_t per_buffer = (budget < largest) ? budget : largest;
+
+    int lines = per_buffer / line_bytes;
+    if (lines > LCD_BUF_LINES_MAX) {
+        lines = LCD_BUF_LINES_MAX;
+    }
+    if (lines < LCD_BUF_LINES) {
+        lines = LCD_BUF_LINES;
+    }
+
+    ESP_LOGI(TAG, "DMA heap: %u free, largest block %u, reserve %u -> %d-line bands (%u bytes x%d), %d flushes per full frame",
+             (unsigned)free_bytes, (unsigned)largest, (unsigned)LCD_DMA_HEAP_RESERVE, lines,
+             (unsigned)(lines * line_bytes), buffers, (LCD_V_RES + lines - 1) / lines);
+
+    return lines;
+}
+
+#if LCD_DIRECT_MODE
+// A full frame fits when it leaves LCD_DMA_HEAP_RESERVE free, typically only
+// in builds without WiFi
+static bool lcd_direct_fits_heap(void)
+{
+    const uint32_t caps = MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL;
+    const size_t frame_bytes = LCD_H_RES * LCD_V_RES * sizeof(uint16_t);
+
+    size_t free_bytes = heap_caps_get_free_size(caps);
+    size_t largest = heap_caps_get_largest_free_block(caps);
+    bool fits = largest >= frame_bytes && free_bytes >= frame_bytes + LCD_DMA_HEAP_RESERVE;
+
+    ESP_LOGI(TAG, "DMA heap: %u free, largest block %u, full frame %u + reserve %u -> %s mode",
+             (unsigned)free_bytes, (unsigned)largest, (unsigned)frame_bytes, (unsigned)LCD_DMA_HEAP_RESERVE,
+             fits ? "direct" : "partial");
+
+    return fits;
+}
+#endif
+
 esp_err_t lcd_display_brightness_init(void)
 {
     ESP_LOGI(TAG, "Initializing LCD backlight with LEDC");
@@ -43,9 +117,16 @@ esp_err_t lcd_display_brightness_init(void)
         .duty_resolution  = LCD_BACKLIGHT_LEDC_RESOLUTION,
         .timer_num        = LEDC_TIMER_0,
         .freq_hz          = 5000,  // 5kHz PWM frequency
+#if CONFIG_PM_ENABLE
+        .clk_cfg          = LEDC_USE_RC_FAST_CLK  // APB stops in light sleep, RC_FAST keeps the PWM running
+#else
         .clk_cfg          = LEDC_AUTO_CLK
+#endif
     };
     ESP_ERROR_CHECK(ledc_timer_config(&ledc_timer));
+#if CONFIG_PM_ENABLE
+    ESP_ERROR_CHECK(esp_sleep_pd_config(ESP_PD_DOMAIN_RC_FAST, ESP_PD_OPTION_ON));
+#endif
     
     // Configure LEDC channel
     ledc_channel_config_t ledc_channel = {
@@ -72,6 +153,7 @@ esp_err_t lcd_display_brightness_set(int brightness_percent)
     }
 
     ESP_LOGI(TAG, "Setting LCD backlight: %d%%", brightness_percent);
+    s_brightness = brightness_percent;
 
     uint32_t duty_cycle = (1023 * brightness_percent) / 100;
 
@@ -81,6 +163,11 @@ esp_err_t lcd_display_brightness_set(int brightness_percent)
     return ESP_OK;
 }
 
+int lcd_display_brightness_get(void)
+{
+    return s_brightness;
+}
+
 esp_err_t lcd_display_backlight_off(void)
 {
     return lcd_display_brightness_set(0);
@@ -95,6 +182,8 @@ esp_err_t lcd_display_rotate(lv_display_t *lvgl_disp, lv_display_rotation_t dir)
 {
     if (lvgl_disp)
     {
+        // Only swaps LVGL's resolution; the pixels are rotated by the panel,
+        // reprogrammed through MADCTL by lcd_flush.c on LV_EVENT_RESOLUTION_CHANGED
         lv_display_set_rotation(lvgl_disp, dir);
         return ESP_OK;
     }
@@ -102,33 +191,25 @@ esp_err_t lcd_display_rotate(lv_display_t *lvgl_disp, lv_display_rotation_t dir)
     return ESP_FAIL;
 }
 
-esp_err_t app_lcd_init(esp_lcd_panel_io_handle_t *lcd_io, esp_lcd_panel_handle_t *lcd_panel)
+static esp_err_t lcd_new_panel_io(uint32_t pclk_hz, esp_lcd_panel_io_handle_t *lcd_io)
 {
-    const spi_bus_config_t buscfg = { 
-        .mosi_io_num = LCD_SPI_MOSI,
-        .miso_io_num = LCD_SPI_MISO,
-        .sclk_io_num = LCD_SPI_CLK,
-        .quadhd_io_num = GPIO_NUM_NC,
-        .quadwp_io_num = GPIO_NUM_NC,
-        .max_transfer_sz = LCD_DRAWBUF_SIZE * sizeof(uint16_t),
-    };
-
-    ESP_RETURN_ON_ERROR(spi_bus_initialize(LCD_SPI_HOST, &buscfg, SPI_DMA_CH_AUTO), TAG, "SPI init failed");
-
-
     const esp_lcd_panel_io_spi_config_t io_config = {
         .cs_gpio_num = LCD_CS,
         .dc_gpio_num = LCD_DC,
         .spi_mode = 0,
-        .pclk_hz = LCD_PIXEL_CLOCK_HZ,
+        .pclk_hz = pclk_hz,
         .trans_queue_depth = 10,
+        .on_color_trans_done = lcd_flush_on_color_trans_done,
+        .user_ctx = NULL,
         .lcd_cmd_bits = LCD_CMD_BITS,
         .lcd_param_bits = LCD_PARAM_BITS,
     };
 
-    ESP_RETURN_ON_ERROR(esp_lcd_new_panel_io_spi((esp_lcd_spi_bus_handle_t)LCD_SPI_HOST, &io_config, lcd_io), TAG, "LCD new panel io failed");
-
+    return esp_lcd_new_panel_io_spi((esp_lcd_spi_bus_handle_t)LCD_SPI_HOST, &io_config, lcd_io);
+}
 
+static esp_err_t lcd_new_panel(esp_lcd_panel_io_handle_t lcd_io, esp_lcd_panel_handle_t *lcd_panel)
+{
     const esp_lcd_panel_dev_config_t panel_config = {
         .reset_gpio_num = LCD_RESET,
         .color_space = ESP_LCD_COLOR_SPACE_BGR, // RGB565
@@ -136,17 +217,97 @@ esp_err_t app_lcd_init(esp_lcd_panel_io_handle_t *lcd_io, esp_lcd_panel_handle_t
     };
 
     #ifdef CYD_ILI9341
-    esp_err_t r = esp_lcd_new_panel_ili9341(*lcd_io, &panel_config, lcd_panel);
+    esp_err_t r = esp_lcd_new_panel_ili9341(lcd_io, &panel_config, lcd_panel);
     #else
-    esp_err_t r = esp_lcd_new_panel_st7789(*lcd_io, &panel_config, lcd_panel);
+    esp_err_t r = esp_lcd_new_panel_st7789(lcd_io, &panel_config, lcd_panel);
     #endif
 
+    if (r != ESP_OK)
+    {
+        return r;
+    }
 
     esp_lcd_panel_reset(*lcd_panel);
     esp_lcd_panel_init(*lcd_panel);
 
-    // Explicitly set the rotation values
-    esp_lcd_panel_swap_xy(*lcd_panel, true);
+    return ESP_OK;
+}
+
+#if LCD_PCLK_CALIBRATE
+// Return the stored pixel clock, calibrating on the first boot
+static uint32_t lcd_pixel_clock_calibrated(void)
+{
+    uint32_t pclk_hz = LCD_PIXEL_CLOCK_HZ;
+
+    if (lcd_clock_load(&pclk_hz) == ESP_OK)
+    {
+        ESP_LOGI(TAG, "Pixel clock %lu Hz (calibrated)", (unsigned long)pclk_hz);
+        return pclk_hz;
+    }
+
+    // Bring the panel out of reset, then release its IO so the calibration
+    // owns the CS line
+    esp_lcd_panel_io_handle_t io = NULL;
+    esp_lcd_panel_handle_t panel = NULL;
+    if (lcd_new_panel_io(LCD_READ_CLOCK_HZ, &io) != ESP_OK)
+    {
+        return LCD_PIXEL_CLOCK_HZ;
+    }
+    if (lcd_new_panel(io, &panel) == ESP_OK)
+    {
+        esp_lcd_panel_del(panel);
+    }
+    esp_lcd_panel_io_del(io);
+
+    int64_t start = esp_timer_get_time();
+    esp_err_t e = lcd_clock_calibrate(&pclk_hz);
+    if (e != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Pixel clock calibration failed (%s), keeping %d Hz", esp_err_to_name(e), LCD_PIXEL_CLOCK_HZ);
+        pclk_hz = LCD_PIXEL_CLOCK_HZ;
+    }
+    else
+    {
+        ESP_LOGI(TAG, "Pixel clock calibrated to %lu Hz in %ld ms", (unsigned long)pclk_hz, (long)((esp_timer_get_time() - start) / 1000));
+    }
+
+    // Also stored on failure, so boards without MISO do not retry every boot
+    lcd_clock_store(pclk_hz);
+
+    return pclk_hz;
+}
+#endif
+
+esp_err_t app_lcd_init(esp_lcd_panel_io_handle_t *lcd_io, esp_lcd_panel_handle_t *lcd_panel)
+{
+    // The band height also bounds the largest SPI transfer
+    s_buf_lines = lcd_drawbuf_lines_from_heap();
+
+    const spi_bus_config_t buscfg = { 
+        .mosi_io_num = LCD_SPI_MOSI,
+        .miso_io_num = LCD_SPI_MISO,
+        .sclk_io_num = LCD_SPI_CLK,
+        .quadhd_io_num = GPIO_NUM_NC,
+        .quadwp_io_num = GPIO_NUM_NC,
+        .max_transfer_sz = LCD_H_RES * s_buf_lines * sizeof(uint16_t),
+    };
+
+    ESP_RETURN_ON_ERROR(spi_bus_initialize(LCD_SPI_HOST, &buscfg, SPI_DMA_CH_AUTO), TAG, "SPI init failed");
+
+    #if LCD_PCLK_CALIBRATE
+    uint32_t pclk_hz = lcd_pixel_clock_calibrated();
+    #else
+    uint32_t pclk_hz = LCD_PIXEL_CLOCK_HZ;
+    #endif
+    lcd_bus_cost_set_pclk(pclk_hz);
+
+    ESP_RETURN_ON_ERROR(lcd_new_panel_io(pclk_hz, lcd_io), TAG, "LCD new panel io failed");
+
+    esp_err_t r = lcd_new_panel(*lcd_io, lcd_panel);
+
+    // Explicitly set the rotation values; lcd_flush.c derives the other
+    // rotations from these
+    esp_lcd_panel_swap_xy(*lcd_panel, LCD_SWAP_XY);
     esp_lcd_panel_mirror(*lcd_panel, LCD_MIRROR_X, LCD_MIRROR_Y);
     esp_lcd_panel_disp_on_off(*lcd_panel, true);
 
@@ -154,12 +315,64 @@ esp_err_t app_lcd_init(esp_lcd_panel_io_handle_t *lcd_io, esp_lcd_panel_handle_t
 }
 
 
+#if LVGL_EVENT_DRIVEN && CONFIG_PM_ENABLE
+// The LVGL task no longer wakes every tick, so let the idle task drop into
+// light sleep between frames
+static void lcd_light_sleep_enable(void)
+{
+    const esp_pm_config_t pm_config = {
+        .max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+        .min_freq_mhz = CONFIG_XTAL_FREQ,
+        .light_sleep_enable = true
+    };
+
+    esp_err_t e = esp_pm_configure(&pm_config);
+    if (e != ESP_OK)
+    {
+        ESP_LOGW(TAG, "esp_pm_configure() failed: %s", esp_err_to_name(e));
+        return;
+    }
+
+    ESP_LOGI(TAG, "Automatic light sleep enabled (%d-%d MHz)", pm_config.min_freq_mhz, pm_config.max_freq_mhz);
+}
+#endif
+
+
+bool app_lvgl_lock(uint32_t timeout_ms)
+{
+#if LVGL_EVENT_DRIVEN
+    return lvgl_task_lock(timeout_ms);
+#else
+    return lvgl_port_lock(timeout_ms);
+#endif
+}
+
+void app_lvgl_unlock(void)
+{
+#if LVGL_EVENT_DRIVEN
+    lvgl_task_unlock();
+#else
+    lvgl_port_unlock();
+#endif
+}
+
+
 lv_display_t *app_lvgl_init(esp_lcd_panel_io_handle_t lcd_io, esp_lcd_panel_handle_t lcd_panel)
 {
+#if LVGL_EVENT_DRIVEN
+    esp_err_t e = lvgl_task_init(LVGL_TASK_PRIORITY, 4096, LVGL_TASK_AFFINITY);
+
+    if (e != ESP_OK)
+    {
+        ESP_LOGI(TAG, "lvgl_task_init() failed: %s", esp_err_to_name(e));
+
+        return NULL;
+    }
+#else
     const lvgl_port_cfg_t lvgl_cfg = {
-        .task_priority = 4,
+        .task_priority = LVGL_TASK_PRIORITY,
         .task_stack = 4096,
-        .task_affinity = -1,
+        .task_affinity = LVGL_TASK_AFFINITY,
         .task_max_sleep_ms = 500,
         .timer_period_ms = 5
     };
@@ -172,36 +385,109 @@ lv_display_t *app_lvgl_init(esp_lcd_panel_io_handle_t lcd_io, esp_lcd_panel_hand
 
         return NULL;
     }
+#endif
+
 
+    ESP_LOGI(TAG, "LVGL task on core %d, %d draw unit(s)", LVGL_TASK_AFFINITY, LV_DRAW_SW_DRAW_UNIT_CNT);
 
     ESP_LOGD(TAG, "Add LCD screen");
-    const lvgl_port_display_cfg_t disp_cfg = {
-        .io_handle = lcd_io,
-        .panel_handle = lcd_panel,
-        .buffer_size = LCD_DRAWBUF_SIZE,
-        .double_buffer = LCD_DOUBLE_BUFFER,
-        .hres = LCD_H_RES,
-        .vres = LCD_V_RES,
-        .monochrome = false,
-        .rotation = {
-            .swap_xy = true,
-            .mirror_x = LCD_MIRROR_X,   // Match hardware settings above
-            .mirror_y = LCD_MIRROR_Y,  // Match hardware settings above
-        },
-        .flags = {
-            .buff_dma = true,
-            .buff_spiram = false,
-            .swap_bytes = true,
-        }
-    };
-    
-    lv_display_t *disp = lvgl_port_add_disp(&disp_cfg);
+    app_lvgl_lock(0);
+
+    // Own flush path instead of lvgl_port_add_disp(), so the flush callback and
+    // the panel IO completion can be instrumented (see lcd_stats.h)
+    lv_display_t *disp = NULL;
+    bool direct = false;
+#if LCD_DIRECT_MODE
+    if (lcd_direct_fits_heap())
+    {
+        disp = lcd_flush_create_direct(lcd_io, lcd_panel);
+        direct = disp != NULL;
+    }
+#endif
+    if (disp == NULL)
+    {
+        disp = lcd_flush_create(lcd_io, lcd_panel, s_buf_lines);
+    }
+    if (disp == NULL)
+    {
+        ESP_LOGE(TAG, "lcd_flush_create() failed");
+        app_lvgl_unlock();
+
+        return NULL;
+    }
+
+#if LV_USE_STDLIB_MALLOC == LV_STDLIB_CUSTOM
+    lvgl_mem_watch_display(disp);
+#endif
+
+    lcd_theme_init(disp, LCD_THEME_LEAN);
+
+    img_rle565_decoder_init();
+
+#if LCD_REFR_GOVERNOR
+    lcd_refresh_governor_init(disp);
+#endif
+    // Both rework the areas of partial-mode bands. In direct mode a fill
+    // would leave the frame stale, and merging would only render more.
+    if (!direct)
+    {
+#if LCD_SOLID_FILL
+        lcd_solid_init(disp, lcd_flush_fill);
+#endif
+#if LCD_MERGE_COST_MODEL
+        lcd_merge_init(disp);
+#endif
+    }
+#if LCD_IDLE_SLEEP
+    lcd_idle_init(disp, lcd_io, lcd_flush_wait_idle);
+#endif
+
+    lv_timer_t *refr = lv_display_get_refr_timer(disp);
+    s_refr_period = lv_timer_get_period(refr);
+    lv_timer_set_period(refr, LCD_REFR_PARKED_MS);
+
+    app_lvgl_unlock();
 
-    lv_theme_t *theme = lv_theme_default_init(disp, lv_palette_main(LV_PALETTE_BLUE), 
-                                             lv_palette_main(LV_PALETTE_RED),
-                                             false,  //  dark theme
-                                             LV_FONT_DEFAULT);
-    lv_disp_set_theme(disp, theme);
+#if LVGL_EVENT_DRIVEN && CONFIG_PM_ENABLE
+    lcd_light_sleep_enable();
+#endif
 
     return disp;
 }
+
+void app_lvgl_show(lv_display_t *disp)
+{
+    app_lvgl_lock(0);
+    lv_timer_set_period(lv_display_get_refr_timer(disp), s_refr_period);
+    lv_refr_now(disp);
+    app_lvgl_unlock();
+}
+
+lv_indev_t *app_lvgl_add_touch(lv_display_t *lvgl_disp, esp_lcd_touch_handle_t tp)
+{
+    app_lvgl_lock(0);
+#if LVGL_EVENT_DRIVEN
+    lv_indev_t *indev = lvgl_task_add_touch(lvgl_disp, tp);
+#else
+    const lvgl_port_touch_cfg_t touch_cfg = {
+        .disp = lvgl_disp,
+        .handle = tp,
+    };
+    lv_indev_t *indev = lvgl_port_add_touch(&touch_cfg);
+#endif
+#if LCD_REFR_GOVERNOR
+    if (indev != NULL)
+    {
+        lcd_refresh_governor_watch_indev(indev);
+    }
+#endif
+#if LCD_IDLE_SLEEP
+    if (indev != NULL)
+    {
+        lcd_idle_watch_indev(indev);
+    }
+#endif
+    app_lvgl_unlock();
+
+    return indev;
+}
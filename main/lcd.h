@@ -3,20 +3,37 @@
 #include <esp_err.h>
 #include <esp_lcd_panel_io.h>
 #include <esp_lcd_panel_ops.h>
+#include <esp_lcd_touch.h>
 #include <lvgl.h>
 
 // Initialize LCD display
 esp_err_t app_lcd_init(esp_lcd_panel_io_handle_t *lcd_io, esp_lcd_panel_handle_t *lcd_panel);
 
-// Initialize LVGL display
+// Initialize LVGL display. Nothing is drawn until app_lvgl_show(), so the
+// splash stays up while the UI is built.
 lv_display_t *app_lvgl_init(esp_lcd_panel_io_handle_t lcd_io, esp_lcd_panel_handle_t lcd_panel);
 
+// Start refreshing disp and draw its first frame now
+void app_lvgl_show(lv_display_t *disp);
+
+// Take the LVGL lock, 0 = wait forever
+bool app_lvgl_lock(uint32_t timeout_ms);
+
+// Release the LVGL lock
+void app_lvgl_unlock(void);
+
+// Register the touch controller as LVGL pointer input
+lv_indev_t *app_lvgl_add_touch(lv_display_t *lvgl_disp, esp_lcd_touch_handle_t tp);
+
 // Initialize LCD backlight
 esp_err_t lcd_display_brightness_init(void);
 
 // Set LCD brightness (0-100%)
 esp_err_t lcd_display_brightness_set(int brightness_percent);
 
+// Last brightness set (0-100%)
+int lcd_display_brightness_get(void);
+
 // Turn off LCD backlight
 esp_err_t lcd_display_backlight_off(void);
 
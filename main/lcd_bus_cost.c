@@ -0,0 +1,91 @@
+#include <stdint.h>
+
+#include "hardware.h"
+#include "lcd_bus_cost.h"
+
+// CASET and PASET each carry start and end as two 16-bit values
+#define LCD_BUS_ADDR_PARAM_BYTES   4
+
+static uint32_t s_pclk_hz = LCD_PIXEL_CLOCK_HZ;
+
+void lcd_bus_cost_set_pclk(uint32_t pclk_hz)
+{
+    if (pclk_hz > 0) {
+        s_pclk_hz = pclk_hz;
+    }
+}
+
+uint32_t lcd_bus_cost_get_pclk(void)
+{
+    return s_pclk_hz;
+}
+
+lcd_bus_cost_t lcd_bus_cost_area(int32_t w, int32_t h)
+{
+    lcd_bus_cost_t cost = { 0 };
+
+    if (w <= 0 || h <= 0) {
+        return cost;
+    }
+
+    // esp_lcd sends a command and its parameters as separate polled transactions:
+    // CASET + params, PASET + params, then RAMWR followed by the queued colour data.
+    cost.transactions = 5;
+    cost.bytes = 3 * (LCD_CMD_BITS / 8) + 2 * LCD_BUS_ADDR_PARAM_BYTES
+               + (uint32_t)w * (uint32_t)h * (LCD_BITS_PIXEL / 8);
+
+    uint64_t bits_ns = (uint64_t)cost.bytes * 8 * 1000000000ULL / s_pclk_hz;
+    cost.time_ns = (uint32_t)(bits_ns + (uint64_t)cost.transactions * LCD_BUS_TRANS_OVERHEAD_NS);
+
+    return cost;
+}
+
+lcd_bus_cost_t lcd_bus_cost_partial(int32_t w, int32_t h, uint32_t buf_px)
+{
+    if (w <= 0 || h <= 0) {
+        return lcd_bus_cost_area(w, h);
+    }
+
+    int32_t rows = (int32_t)(buf_px / (uint32_t)w);
+    if (rows < 1) {
+        rows = 1;
+    }
+    if (rows > h) {
+        rows = h;
+    }
+
+    const uint32_t chunks = h / rows;
+    lcd_bus_cost_t cost = lcd_bus_cost_area(w, rows);
+    cost.transactions *= chunks;
+    cost.bytes *= chunks;
+    cost.time_ns *= chunks;
+
+    if (h % rows != 0) {
+        lcd_bus_cost_t tail = lcd_bus_cost_area(w, h % rows);
+        cost.transactions += tail.transactions;
+        cost.bytes += tail.bytes;
+        cost.time_ns += tail.time_ns;
+    }
+
+    return cost;
+}
+
+lcd_bus_cost_t lcd_bus_cost_fill(int32_t w, int32_t h, uint32_t chunk_px)
+{
+    lcd_bus_cost_t cost = { 0 };
+
+    if (w <= 0 || h <= 0 || chunk_px == 0) {
+        return cost;
+    }
+
+    const uint32_t px = (uint32_t)w * (uint32_t)h;
+    const uint32_t chunks = (px + chunk_px - 1) / chunk_px;
+
+    cost.transactions = 4 + 2 * chunks;
+    cost.bytes = (2 + chunks) * (LCD_CMD_BITS / 8) + 2 * LCD_BUS_ADDR_PARAM_BYTES + px * (LCD_BITS_PIXEL / 8);
+
+    uint64_t bits_ns = (uint64_t)cost.bytes * 8 * 1000000000ULL / s_pclk_hz;
+    cost.time_ns = (uint32_t)(bits_ns + (uint64_t)cost.transactions * LCD_BUS_TRANS_OVERHEAD_NS);
+
+    return cost;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdint.h>
+
+// Fixed cost of one esp_lcd SPI panel IO transaction: CS/DC handling, queueing
+// and driver setup. Applies to every command, parameter and colour transfer.
+#define LCD_BUS_TRANS_OVERHEAD_NS  (4 * 1000)
+
+typedef struct {
+    uint32_t transactions; // SPI transactions issued
+    uint32_t bytes;        // Bytes clocked out, command and parameter bytes included
+    uint32_t time_ns;      // Modelled bus time
+} lcd_bus_cost_t;
+
+// Set the SPI pixel clock used by the cost model (defaults to LCD_PIXEL_CLOCK_HZ)
+void lcd_bus_cost_set_pclk(uint32_t pclk_hz);
+
+// Get the SPI pixel clock used by the cost model
+uint32_t lcd_bus_cost_get_pclk(void);
+
+// Model the CASET/PASET/RAMWR sequence that writes a w x h RGB565 area to the panel
+lcd_bus_cost_t lcd_bus_cost_area(int32_t w, int32_t h);
+
+// Model an area drawn through a partial-mode draw buffer of buf_px pixels:
+// LVGL renders and flushes it in chunks of buf_px / w rows, each chunk one
+// CASET/PASET/RAMWR sequence
+lcd_bus_cost_t lcd_bus_cost_partial(int32_t w, int32_t h, uint32_t buf_px);
+
+// Model a w x h solid fill sent from a chunk_px-pixel buffer: CASET/PASET,
+// then RAMWR or memory-write-continue plus one chunk per transaction
+lcd_bus_cost_t lcd_bus_cost_fill(int32_t w, int32_t h, uint32_t chunk_px);
@@ -0,0 +1,192 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <esp_log.h>
+#include <esp_err.h>
+#include <esp_check.h>
+#include <esp_heap_caps.h>
+#include <esp_lcd_panel_io.h>
+#include <esp_lcd_panel_commands.h>
+#include <nvs.h>
+
+#include "hardware.h"
+#include "lcd_clock.h"
+
+static const char *TAG = "lcd_clock";
+
+#define LCD_CLOCK_NVS_NAMESPACE  "lcd"
+#define LCD_CLOCK_NVS_KEY        "pclk_hz"
+
+// Test window in the top-left corner, overwritten by the first UI frame
+#define LCD_CLOCK_PATTERN_W      32
+#define LCD_CLOCK_PATTERN_H      8
+#define LCD_CLOCK_PATTERN_PX     (LCD_CLOCK_PATTERN_W * LCD_CLOCK_PATTERN_H)
+
+// RAMRD returns a dummy byte followed by up to 3 bytes (RGB666) per pixel
+#define LCD_CLOCK_READ_BYTES     (1 + LCD_CLOCK_PATTERN_PX * 3)
+
+// Clocks the ESP32 SPI master can generate from the 80 MHz APB, fastest first
+static const uint32_t s_candidates_hz[] = {
+    80 * 1000 * 1000,
+    40 * 1000 * 1000,
+    80 * 1000 * 1000 / 3,
+    20 * 1000 * 1000,
+};
+
+static esp_err_t lcd_clock_new_io(uint32_t pclk_hz, esp_lcd_panel_io_handle_t *io)
+{
+    const esp_lcd_panel_io_spi_config_t io_config = {
+        .cs_gpio_num = LCD_CS,
+        .dc_gpio_num = LCD_DC,
+        .spi_mode = 0,
+        .pclk_hz = pclk_hz,
+        .trans_queue_depth = 1,
+        .lcd_cmd_bits = LCD_CMD_BITS,
+        .lcd_param_bits = LCD_PARAM_BITS,
+    };
+
+    return esp_lcd_new_panel_io_spi((esp_lcd_spi_bus_handle_t)LCD_SPI_HOST, &io_config, io);
+}
+
+static esp_err_t lcd_clock_set_window(esp_lcd_panel_io_handle_t io)
+{
+    const uint8_t caset[4] = { 0, 0, (LCD_CLOCK_PATTERN_W - 1) >> 8, (LCD_CLOCK_PATTERN_W - 1) & 0xff };
+    const uint8_t raset[4] = { 0, 0, (LCD_CLOCK_PATTERN_H - 1) >> 8, (LCD_CLOCK_PATTERN_H - 1) & 0xff };
+
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, LCD_CMD_CASET, caset, sizeof(caset)), TAG, "CASET failed");
+    return esp_lcd_panel_io_tx_param(io, LCD_CMD_RASET, raset, sizeof(raset));
+}
+
+// Write the pattern with a short-lived IO at pclk_hz; deleting the IO waits
+// for the colour transfer to finish
+static esp_err_t lcd_clock_write(uint32_t pclk_hz, const uint16_t *pattern)
+{
+    esp_lcd_panel_io_handle_t io = NULL;
+
+    ESP_RETURN_ON_ERROR(lcd_clock_new_io(pclk_hz, &io), TAG, "IO at %lu Hz failed", (unsigned long)pclk_hz);
+
+    esp_err_t ret = lcd_clock_set_window(io);
+    if (ret == ESP_OK) {
+        ret = esp_lcd_panel_io_tx_color(io, LCD_CMD_RAMWR, pattern, LCD_CLOCK_PATTERN_PX * sizeof(uint16_t));
+    }
+    esp_lcd_panel_io_del(io);
+
+    return ret;
+}
+
+static esp_err_t lcd_clock_read(uint8_t *data)
+{
+    esp_lcd_panel_io_handle_t io = NULL;
+
+    ESP_RETURN_ON_ERROR(lcd_clock_new_io(LCD_READ_CLOCK_HZ, &io), TAG, "read IO failed");
+
+    esp_err_t ret = lcd_clock_set_window(io);
+    if (ret == ESP_OK) {
+        ret = esp_lcd_panel_io_rx_param(io, LCD_CMD_RAMRD, data, LCD_CLOCK_READ_BYTES);
+    }
+    esp_lcd_panel_io_del(io);
+
+    return ret;
+}
+
+esp_err_t lcd_clock_load(uint32_t *pclk_hz)
+{
+    nvs_handle_t nvs;
+
+    ESP_RETURN_ON_ERROR(nvs_open(LCD_CLOCK_NVS_NAMESPACE, NVS_READONLY, &nvs), TAG, "no calibration stored");
+    esp_err_t ret = nvs_get_u32(nvs, LCD_CLOCK_NVS_KEY, pclk_hz);
+    nvs_close(nvs);
+
+    return ret;
+}
+
+esp_err_t lcd_clock_store(uint32_t pclk_hz)
+{
+    nvs_handle_t nvs;
+
+    ESP_RETURN_ON_ERROR(nvs_open(LCD_CLOCK_NVS_NAMESPACE, NVS_READWRITE, &nvs), TAG, "nvs_open failed");
+    esp_err_t ret = nvs_set_u32(nvs, LCD_CLOCK_NVS_KEY, pclk_hz);
+    if (ret == ESP_OK) {
+        ret = nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+
+    return ret;
+}
+
+esp_err_t lcd_clock_forget(void)
+{
+    nvs_handle_t nvs;
+
+    ESP_RETURN_ON_ERROR(nvs_open(LCD_CLOCK_NVS_NAMESPACE, NVS_READWRITE, &nvs), TAG, "nvs_open failed");
+    esp_err_t ret = nvs_erase_key(nvs, LCD_CLOCK_NVS_KEY);
+    if (ret == ESP_OK || ret == ESP_ERR_NVS_NOT_FOUND) {
+        ret = nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+
+    return ret;
+}
+
+esp_err_t lcd_clock_calibrate(uint32_t *pclk_hz)
+{
+    esp_err_t ret = ESP_OK;
+    uint16_t *pattern = heap_caps_malloc(LCD_CLOCK_PATTERN_PX * sizeof(uint16_t), MALLOC_CAP_DMA);
+    uint16_t *inverse = heap_caps_malloc(LCD_CLOCK_PATTERN_PX * sizeof(uint16_t), MALLOC_CAP_DMA);
+    uint8_t *reference = heap_caps_malloc(LCD_CLOCK_READ_BYTES, MALLOC_CAP_DMA);
+    uint8_t *readback = heap_caps_malloc(LCD_CLOCK_READ_BYTES, MALLOC_CAP_DMA);
+
+    ESP_GOTO_ON_FALSE(pattern && inverse && reference && readback, ESP_ERR_NO_MEM, out, TAG, "no memory");
+
+    // Alternating bits exercise every data line edge; the LFSR rows catch
+    // sampling slips that a periodic pattern would hide
+    uint16_t lfsr = 0xACE1;
+    for (int i = 0; i < LCD_CLOCK_PATTERN_PX; i++) {
+        if ((i / LCD_CLOCK_PATTERN_W) % 2 == 0) {
+            pattern[i] = (i % 2) ? 0xAAAA : 0x5555;
+        } else {
+            lfsr = (lfsr >> 1) ^ (-(lfsr & 1u) & 0xB400u);
+            pattern[i] = lfsr;
+        }
+        inverse[i] = ~pattern[i];
+    }
+
+    // The read clock is slow enough to trust: what the panel returns for a
+    // pattern written at that clock is the reference for every candidate
+    ESP_GOTO_ON_ERROR(lcd_clock_write(LCD_READ_CLOCK_HZ, pattern), out, TAG, "reference write failed");
+    ESP_GOTO_ON_ERROR(lcd_clock_read(reference), out, TAG, "RAMRD failed");
+
+    bool varied = false;
+    for (int i = 2; i < LCD_CLOCK_READ_BYTES && !varied; i++) {
+        varied = reference[i] != reference[1];
+    }
+    ESP_GOTO_ON_FALSE(varied, ESP_ERR_NOT_SUPPORTED, out, TAG, "RAMRD returned constant data, is LCD_SPI_MISO connected?");
+
+    ret = ESP_ERR_NOT_FOUND;
+    for (int c = 0; c < sizeof(s_candidates_hz) / sizeof(s_candidates_hz[0]); c++) {
+        bool verified = true;
+
+        for (int pass = 0; pass < LCD_PCLK_CALIBRATE_PASSES && verified; pass++) {
+            // Overwrite the window first, so a write that never lands cannot pass
+            verified = lcd_clock_write(LCD_READ_CLOCK_HZ, inverse) == ESP_OK
+                    && lcd_clock_write(s_candidates_hz[c], pattern) == ESP_OK
+                    && lcd_clock_read(readback) == ESP_OK
+                    && memcmp(readback + 1, reference + 1, LCD_CLOCK_READ_BYTES - 1) == 0;
+        }
+
+        ESP_LOGI(TAG, "%lu Hz: %s", (unsigned long)s_candidates_hz[c], verified ? "verified" : "corrupt");
+        if (verified) {
+            *pclk_hz = s_candidates_hz[c];
+            ret = ESP_OK;
+            break;
+        }
+    }
+
+out:
+    heap_caps_free(pattern);
+    heap_caps_free(inverse);
+    heap_caps_free(reference);
+    heap_caps_free(readback);
+
+    return ret;
+}
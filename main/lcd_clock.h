@@ -0,0 +1,19 @@
+#pragma once
+
+#include <stdint.h>
+#include <esp_err.h>
+
+// Load the pixel clock stored by a previous calibration
+esp_err_t lcd_clock_load(uint32_t *pclk_hz);
+
+// Store the pixel clock for the next boot
+esp_err_t lcd_clock_store(uint32_t pclk_hz);
+
+// Forget the stored pixel clock so the next boot calibrates again
+esp_err_t lcd_clock_forget(void);
+
+// Find the fastest pixel clock at which a test pattern written to the panel
+// reads back intact through RAMRD on LCD_SPI_MISO. The panel must have been
+// initialised, and no other panel IO may be attached to LCD_CS while this runs.
+// Returns ESP_ERR_NOT_SUPPORTED when the panel returns no usable read data.
+esp_err_t lcd_clock_calibrate(uint32_t *pclk_hz);
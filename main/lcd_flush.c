@@ -0,0 +1,514 @@
+#include <stdio.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#include <esp_attr.h>
+#include <esp_log.h>
+#include <esp_err.h>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+#include <esp_lcd_panel_io.h>
+#include <esp_lcd_panel_ops.h>
+#include <esp_lcd_panel_commands.h>
+#include <lvgl.h>
+
+#include "hardware.h"
+#include "lcd_flush.h"
+#include "lcd_hash.h"
+#include "lcd_pixel.h"
+#include "lcd_refresh.h"
+#include "lcd_rows.h"
+#include "lcd_stats.h"
+#include "lvgl_mem.h"
+#include "static_cache.h"
+
+static const char *TAG = "lcd_flush";
+
+typedef struct {
+    esp_lcd_panel_io_handle_t io;
+    esp_lcd_panel_handle_t panel;
+    lv_display_t *disp;
+    int64_t render_start_us;     // LV_EVENT_RENDER_START of the current frame
+    int64_t frame_wait_us;       // Flush wait accumulated in the current frame
+    int64_t wait_start_us;       // LV_EVENT_FLUSH_WAIT_START
+    volatile int64_t dma_start_us; // draw_bitmap issued for the in-flight flush
+    volatile int64_t dma_queued_us; // draw_bitmap returned, colour DMA running
+    volatile int64_t dma_done_us;  // on_color_trans_done of the last flush
+    volatile bool in_flight;       // A band buffer is owned by the SPI DMA
+    SemaphoreHandle_t trans_done;  // Given from the ISR when a colour transfer completes
+#if LCD_SOLID_FILL
+    uint16_t *fill_buf;            // LCD_SOLID_FILL_LINES rows of fill_color, panel byte order
+    uint16_t fill_color;
+    volatile uint32_t fill_pending; // Fill chunks queued and not yet sent
+#endif
+#if LCD_DIRECT_MODE
+    uint16_t *frame;               // Direct mode: the full frame LVGL renders into, NULL in partial mode
+    lcd_rows_t rows;               // Direct mode: rows refreshed so far in this frame
+    volatile uint32_t spans_pending; // Direct mode: row transfers queued and not yet sent
+#endif
+} lcd_flush_ctx_t;
+
+static lcd_flush_ctx_t s_ctx;
+
+#if LCD_SOLID_FILL
+static portMUX_TYPE s_fill_lock = portMUX_INITIALIZER_UNLOCKED;
+#endif
+
+#if LCD_PIPELINED_FLUSH && !LCD_DOUBLE_BUFFER
+#error "LCD_PIPELINED_FLUSH needs LCD_DOUBLE_BUFFER: LVGL renders one band while the other is on the bus"
+#endif
+
+// Colour transfer finished: the band buffer can be reused. Runs in the SPI ISR.
+bool IRAM_ATTR lcd_flush_on_color_trans_done(esp_lcd_panel_io_handle_t io, esp_lcd_panel_io_event_data_t *edata, void *user_ctx)
+{
+    lcd_flush_ctx_t *ctx = &s_ctx;
+    BaseType_t need_yield = pdFALSE;
+
+#if LCD_SOLID_FILL
+    // Fills are only queued while no band is in flight, so their chunks
+    // complete before the next band
+    portENTER_CRITICAL_SAFE(&s_fill_lock);
+    bool fill = ctx->fill_pending > 0;
+    if (fill) {
+        ctx->fill_pending--;
+    }
+    portEXIT_CRITICAL_SAFE(&s_fill_lock);
+
+    if (fill) {
+        if (ctx->fill_pending == 0) {
+            xSemaphoreGiveFromISR(ctx->trans_done, &need_yield);
+        }
+        return need_yield == pdTRUE;
+    }
+#endif
+
+    if (ctx->disp == NULL || !ctx->in_flight) {
+        return false;
+    }
+
+#if LCD_DIRECT_MODE
+    // A direct-mode frame is on the panel when its last row span is
+    if (ctx->spans_pending > 1) {
+        ctx->spans_pending--;
+        return false;
+    }
+    ctx->spans_pending = 0;
+#endif
+
+    ctx->dma_done_us = esp_timer_get_time();
+    ctx->in_flight = false;
+    lcd_stats_record(LCD_STATS_DMA_US, (uint32_t)(ctx->dma_done_us - ctx->dma_start_us));
+    lv_display_flush_ready(ctx->disp);
+
+#if LCD_PIPELINED_FLUSH || LCD_SOLID_FILL
+    xSemaphoreGiveFromISR(ctx->trans_done, &need_yield);
+#endif
+
+    return need_yield == pdTRUE;
+}
+
+#if LCD_PIPELINED_FLUSH
+// Called by LVGL before it hands the next band to lcd_flush_cb(). Blocks the
+// LVGL task instead of spinning on the flushing flag, so the core is free for
+// other work while the previous band is clocked out.
+static void lcd_flush_wait_cb(lv_display_t *disp)
+{
+    lcd_flush_ctx_t *ctx = lv_display_get_driver_data(disp);
+
+    // A stale give from an earlier transfer only costs one extra loop
+    while (ctx->in_flight) {
+        xSemaphoreTake(ctx->trans_done, portMAX_DELAY);
+    }
+}
+#endif
+
+static void lcd_flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+{
+    lcd_flush_ctx_t *ctx = lv_display_get_driver_data(disp);
+
+#if LCD_FLUSH_HASH
+    // Rows the panel already shows are neither swapped nor sent
+    lv_area_t send;
+    if (!lcd_hash_check(area, (const uint16_t *)px_map, &send)) {
+        lv_display_flush_ready(disp);
+        return;
+    }
+    px_map += (send.y1 - area->y1) * lv_area_get_width(area) * sizeof(uint16_t);
+    area = &send;
+#endif
+
+    uint32_t px = lv_area_get_size(area);
+
+#if !LCD_PIXEL_NATIVE_SWAPPED
+    // The panel expects big-endian RGB565
+    lcd_pixel_swap_rgb565(px_map, px);
+#endif
+
+    lcd_stats_record(LCD_STATS_FLUSH_AREA, px);
+    lcd_stats_record(LCD_STATS_FLUSH_BYTES, px * sizeof(uint16_t));
+
+    ctx->in_flight = true;
+    ctx->dma_start_us = esp_timer_get_time();
+    esp_lcd_panel_draw_bitmap(ctx->panel, area->x1, area->y1, area->x2 + 1, area->y2 + 1, px_map);
+    ctx->dma_queued_us = esp_timer_get_time();
+
+    // Return with the transfer still running; lv_display_flush_ready() is
+    // signalled from lcd_flush_on_color_trans_done()
+}
+
+#if LCD_DIRECT_MODE && LCD_PIXEL_NATIVE_SWAPPED
+// LVGL renders each dirty area into the frame in place and flushes it; the
+// rows are collected and sent together with the frame's last area. Rows of a
+// full frame are contiguous, so an area costs one transfer of full-width rows
+// instead of one per band.
+static void lcd_flush_direct_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+{
+    lcd_flush_ctx_t *ctx = lv_display_get_driver_data(disp);
+    const int32_t stride = lv_display_get_horizontal_resolution(disp);
+
+    ctx->rows.width = stride;
+    lcd_rows_add(&ctx->rows, area->y1, area->y2);
+    if (!lv_display_flush_is_last(disp)) {
+        lv_display_flush_ready(disp);
+        return;
+    }
+
+    // Decide every span before queueing, so the ISR knows how many to count
+    lv_area_t send[LCD_ROWS_MAX_SPANS];
+    uint32_t spans = 0;
+    for (int i = 0; i < ctx->rows.count; i++) {
+        lv_area_t rows = { 0, ctx->rows.span[i].y1, stride - 1, ctx->rows.span[i].y2 };
+#if LCD_FLUSH_HASH
+        if (!lcd_hash_check(&rows, &ctx->frame[rows.y1 * stride], &send[spans])) {
+            continue;
+        }
+#else
+        send[spans] = rows;
+#endif
+        spans++;
+    }
+    lcd_rows_reset(&ctx->rows, stride);
+
+    if (spans == 0) {
+        lv_display_flush_ready(disp);
+        return;
+    }
+
+    // The frame is rendered as RGB565_SWAPPED, so it goes out as it is. LVGL
+    // waits for lv_display_flush_ready() before drawing into it again.
+    ctx->spans_pending = spans;
+    ctx->in_flight = true;
+    ctx->dma_start_us = esp_timer_get_time();
+    for (uint32_t i = 0; i < spans; i++) {
+        const uint32_t px = lv_area_get_size(&send[i]);
+
+        lcd_stats_record(LCD_STATS_FLUSH_AREA, px);
+        lcd_stats_record(LCD_STATS_FLUSH_BYTES, px * sizeof(uint16_t));
+        esp_lcd_panel_draw_bitmap(ctx->panel, 0, send[i].y1, stride, send[i].y2 + 1, &ctx->frame[send[i].y1 * stride]);
+    }
+    ctx->dma_queued_us = esp_timer_get_time();
+}
+#endif
+
+#if LCD_SOLID_FILL
+void lcd_flush_fill(lv_display_t *disp, const lv_area_t *area, lv_color_t color)
+{
+    lcd_flush_ctx_t *ctx = lv_display_get_driver_data(disp);
+    uint16_t px = lv_color_to_u16(color);
+
+    // Panel byte order
+    px = (uint16_t)((px >> 8) | (px << 8));
+
+    // Nothing may be in flight: the band's completion must not be taken for a
+    // fill chunk's, and the fill buffer may still be on the bus
+    while (ctx->in_flight || ctx->fill_pending > 0) {
+        xSemaphoreTake(ctx->trans_done, pdMS_TO_TICKS(10));
+    }
+
+    if (px != ctx->fill_color) {
+        for (uint32_t i = 0; i < LCD_H_RES * LCD_SOLID_FILL_LINES; i++) {
+            ctx->fill_buf[i] = px;
+        }
+        ctx->fill_color = px;
+    }
+
+    const uint8_t caset[4] = { area->x1 >> 8, area->x1 & 0xff, area->x2 >> 8, area->x2 & 0xff };
+    const uint8_t raset[4] = { area->y1 >> 8, area->y1 & 0xff, area->y2 >> 8, area->y2 & 0xff };
+    esp_lcd_panel_io_tx_param(ctx->io, LCD_CMD_CASET, caset, sizeof(caset));
+    esp_lcd_panel_io_tx_param(ctx->io, LCD_CMD_RASET, raset, sizeof(raset));
+
+    // One small buffer sent over and over: RAMWR for the first chunk, then
+    // memory-write-continue, which carries on where the last chunk stopped
+    uint32_t left = lv_area_get_size(area);
+    int cmd = LCD_CMD_RAMWR;
+    while (left > 0) {
+        const uint32_t n = LV_MIN(left, LCD_H_RES * LCD_SOLID_FILL_LINES);
+
+        portENTER_CRITICAL(&s_fill_lock);
+        ctx->fill_pending++;
+        portEXIT_CRITICAL(&s_fill_lock);
+        if (esp_lcd_panel_io_tx_color(ctx->io, cmd, ctx->fill_buf, n * sizeof(uint16_t)) != ESP_OK) {
+            portENTER_CRITICAL(&s_fill_lock);
+            ctx->fill_pending--;
+            portEXIT_CRITICAL(&s_fill_lock);
+            ESP_LOGW(TAG, "Fill of %dx%d at (%d,%d) failed", (int)lv_area_get_width(area),
+                     (int)lv_area_get_height(area), (int)area->x1, (int)area->y1);
+            return;
+        }
+
+        cmd = LCD_CMD_WRMEMC;
+        left -= n;
+    }
+
+    lcd_stats_record(LCD_STATS_FILL_AREA, lv_area_get_size(area));
+#if LCD_FLUSH_HASH
+    lcd_hash_forget(area);
+#endif
+}
+#endif
+
+void lcd_flush_wait_idle(lv_display_t *disp)
+{
+    lcd_flush_ctx_t *ctx = lv_display_get_driver_data(disp);
+
+    // The semaphore is only given with LCD_PIPELINED_FLUSH or LCD_SOLID_FILL,
+    // so poll as well
+#if LCD_SOLID_FILL
+    while (ctx->in_flight || ctx->fill_pending > 0) {
+#else
+    while (ctx->in_flight) {
+#endif
+        xSemaphoreTake(ctx->trans_done, pdMS_TO_TICKS(10));
+    }
+}
+
+// Rotate in the panel (MADCTL swap_xy/mirror) relative to the orientation set
+// in app_lcd_init(), so LVGL never has to rotate pixels before a flush
+static void lcd_flush_apply_rotation(lcd_flush_ctx_t *ctx, lv_display_rotation_t rotation)
+{
+    bool swap_xy = LCD_SWAP_XY;
+    bool mirror_x = LCD_MIRROR_X;
+    bool mirror_y = LCD_MIRROR_Y;
+
+    switch (rotation) {
+    case LV_DISPLAY_ROTATION_90:
+        swap_xy = !LCD_SWAP_XY;
+        if (LCD_SWAP_XY) {
+            mirror_x = !LCD_MIRROR_X;
+        } else {
+            mirror_y = !LCD_MIRROR_Y;
+        }
+        break;
+    case LV_DISPLAY_ROTATION_180:
+        mirror_x = !LCD_MIRROR_X;
+        mirror_y = !LCD_MIRROR_Y;
+        break;
+    case LV_DISPLAY_ROTATION_270:
+        swap_xy = !LCD_SWAP_XY;
+        if (LCD_SWAP_XY) {
+            mirror_y = !LCD_MIRROR_Y;
+        } else {
+            mirror_x = !LCD_MIRROR_X;
+        }
+        break;
+    default:
+        break;
+    }
+
+    // Both calls are polled command transfers, so they wait for the band on the bus
+    esp_lcd_panel_swap_xy(ctx->panel, swap_xy);
+    esp_lcd_panel_mirror(ctx->panel, mirror_x, mirror_y);
+
+#if LCD_FLUSH_HASH
+    // Same coordinates now address different GRAM
+    lcd_hash_reset();
+#endif
+
+    ESP_LOGI(TAG, "Rotation %d: swap_xy=%d mirror_x=%d mirror_y=%d", rotation * 90, swap_xy, mirror_x, mirror_y);
+}
+
+static void lcd_flush_event_cb(lv_event_t *e)
+{
+    lcd_flush_ctx_t *ctx = lv_event_get_user_data(e);
+    int64_t now = esp_timer_get_time();
+
+    switch (lv_event_get_code(e)) {
+    case LV_EVENT_RENDER_START:
+        ctx->render_start_us = now;
+        ctx->frame_wait_us = 0;
+        break;
+    case LV_EVENT_FLUSH_WAIT_START:
+        ctx->wait_start_us = now;
+        // Time LVGL spent rendering while the previous band was on the bus
+        if (ctx->dma_queued_us > 0) {
+            int64_t overlap_end = ctx->in_flight ? now : ctx->dma_done_us;
+            lcd_stats_record(LCD_STATS_OVERLAP_US, (uint32_t)(overlap_end > ctx->dma_queued_us ? overlap_end - ctx->dma_queued_us : 0));
+            ctx->dma_queued_us = 0;
+        }
+        break;
+    case LV_EVENT_FLUSH_WAIT_FINISH:
+        lcd_stats_record(LCD_STATS_FLUSH_WAIT_US, (uint32_t)(now - ctx->wait_start_us));
+        ctx->frame_wait_us += now - ctx->wait_start_us;
+        break;
+    case LV_EVENT_RENDER_READY:
+        lcd_stats_record(LCD_STATS_RENDER_US, (uint32_t)(now - ctx->render_start_us - ctx->frame_wait_us));
+        break;
+    case LV_EVENT_RESOLUTION_CHANGED:
+        lcd_flush_apply_rotation(ctx, lv_display_get_rotation(ctx->disp));
+        break;
+    default:
+        break;
+    }
+}
+
+#if LCD_STATS_LOG_PERIOD_MS > 0
+static void lcd_stats_log_timer_cb(lv_timer_t *timer)
+{
+    lcd_refresh_info_t refr;
+
+    lcd_stats_dump();
+    static_cache_dump();
+#if LV_USE_STDLIB_MALLOC == LV_STDLIB_CUSTOM
+    lvgl_mem_dump();
+#endif
+    lcd_refresh_get_info(&refr);
+    ESP_LOGI(TAG, "refresh: %u ms period (%s), %u fps, %u rate changes", (unsigned)refr.period_ms,
+             refr.active ? "fast" : "idle", (unsigned)refr.fps, (unsigned)refr.switches);
+}
+#endif
+
+// Create the display around already allocated buffers; the caller frees them on failure
+static lv_display_t *lcd_flush_display_new(esp_lcd_panel_io_handle_t lcd_io, esp_lcd_panel_handle_t lcd_panel,
+                                           void *buf1, void *buf2, size_t buf_bytes, lv_display_render_mode_t mode)
+{
+    lv_display_t *disp = lv_display_create(LCD_H_RES, LCD_V_RES);
+    if (disp == NULL) {
+        return NULL;
+    }
+
+#if LCD_PIPELINED_FLUSH || LCD_SOLID_FILL
+    s_ctx.trans_done = xSemaphoreCreateBinary();
+    if (s_ctx.trans_done == NULL) {
+        lv_display_delete(disp);
+        return NULL;
+    }
+#endif
+
+#if LCD_SOLID_FILL
+    // Zeroed, so it already holds black. Direct mode has no solid fills.
+    if (mode == LV_DISPLAY_RENDER_MODE_PARTIAL) {
+        s_ctx.fill_buf = heap_caps_calloc(LCD_H_RES * LCD_SOLID_FILL_LINES, sizeof(uint16_t), MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        if (s_ctx.fill_buf == NULL) {
+            vSemaphoreDelete(s_ctx.trans_done);
+            lv_display_delete(disp);
+            return NULL;
+        }
+    }
+#endif
+
+    s_ctx.io = lcd_io;
+    s_ctx.panel = lcd_panel;
+
+    lv_display_set_color_format(disp, LCD_PIXEL_RENDER_FORMAT);
+    lv_display_set_buffers(disp, buf1, buf2, buf_bytes, mode);
+    lv_display_set_driver_data(disp, &s_ctx);
+    lv_display_set_flush_cb(disp, lcd_flush_cb);
+#if LCD_PIPELINED_FLUSH
+    lv_display_set_flush_wait_cb(disp, lcd_flush_wait_cb);
+#endif
+
+    lv_display_add_event_cb(disp, lcd_flush_event_cb, LV_EVENT_RENDER_START, &s_ctx);
+    lv_display_add_event_cb(disp, lcd_flush_event_cb, LV_EVENT_RENDER_READY, &s_ctx);
+    lv_display_add_event_cb(disp, lcd_flush_event_cb, LV_EVENT_FLUSH_WAIT_START, &s_ctx);
+    lv_display_add_event_cb(disp, lcd_flush_event_cb, LV_EVENT_FLUSH_WAIT_FINISH, &s_ctx);
+    lv_display_add_event_cb(disp, lcd_flush_event_cb, LV_EVENT_RESOLUTION_CHANGED, &s_ctx);
+
+    // Completion callbacks are accepted from here on
+    s_ctx.disp = disp;
+
+#if LCD_STATS_LOG_PERIOD_MS > 0
+    lv_timer_create(lcd_stats_log_timer_cb, LCD_STATS_LOG_PERIOD_MS, NULL);
+#endif
+
+    ESP_LOGI(TAG, "Rendering %s", LCD_PIXEL_NATIVE_SWAPPED ? "RGB565_SWAPPED natively" : "RGB565, byte swap at flush");
+
+    return disp;
+}
+
+lv_display_t *lcd_flush_create(esp_lcd_panel_io_handle_t lcd_io, esp_lcd_panel_handle_t lcd_panel, int buf_lines)
+{
+    void *buf1 = NULL;
+    void *buf2 = NULL;
+    size_t buf_bytes = 0;
+
+    // The heap may have fragmented since the band height was chosen
+    while (true) {
+        buf_bytes = LCD_H_RES * buf_lines * sizeof(uint16_t);
+        buf1 = heap_caps_malloc(buf_bytes, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        buf2 = LCD_DOUBLE_BUFFER ? heap_caps_malloc(buf_bytes, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL) : NULL;
+        if (buf1 != NULL && (!LCD_DOUBLE_BUFFER || buf2 != NULL)) {
+            break;
+        }
+        heap_caps_free(buf1);
+        heap_caps_free(buf2);
+        buf1 = buf2 = NULL;
+        if (buf_lines <= LCD_BUF_LINES) {
+            break;
+        }
+        ESP_LOGW(TAG, "Could not allocate %d-line draw buffers", buf_lines);
+        buf_lines = (buf_lines / 2 > LCD_BUF_LINES) ? buf_lines / 2 : LCD_BUF_LINES;
+    }
+
+    if (buf1 == NULL) {
+        ESP_LOGE(TAG, "Not enough DMA memory for %d-line draw buffers", LCD_BUF_LINES);
+        return NULL;
+    }
+
+    lv_display_t *disp = lcd_flush_display_new(lcd_io, lcd_panel, buf1, buf2, buf_bytes, LV_DISPLAY_RENDER_MODE_PARTIAL);
+    if (disp == NULL) {
+        heap_caps_free(buf1);
+        heap_caps_free(buf2);
+        return NULL;
+    }
+
+    ESP_LOGI(TAG, "Display %dx%d, %d-line band buffers x%d, %d flushes per full frame, %s flush", LCD_H_RES, LCD_V_RES,
+             buf_lines, LCD_DOUBLE_BUFFER ? 2 : 1, (LCD_V_RES + buf_lines - 1) / buf_lines, LCD_PIPELINED_FLUSH ? "pipelined" : "busy-wait");
+
+    return disp;
+}
+
+#if LCD_DIRECT_MODE
+lv_display_t *lcd_flush_create_direct(esp_lcd_panel_io_handle_t lcd_io, esp_lcd_panel_handle_t lcd_panel)
+{
+#if !LCD_PIXEL_NATIVE_SWAPPED
+    // Swapping at flush would scramble the frame LVGL draws on next
+    ESP_LOGW(TAG, "Direct mode needs RGB565_SWAPPED rendering, which this LVGL build lacks");
+    return NULL;
+#else
+    const size_t frame_bytes = LCD_H_RES * LCD_V_RES * sizeof(uint16_t);
+    uint16_t *frame = heap_caps_malloc(frame_bytes, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+
+    if (frame == NULL) {
+        ESP_LOGW(TAG, "Could not allocate a %u-byte frame", (unsigned)frame_bytes);
+        return NULL;
+    }
+
+    s_ctx.frame = frame;
+    lcd_rows_reset(&s_ctx.rows, LCD_H_RES);
+
+    lv_display_t *disp = lcd_flush_display_new(lcd_io, lcd_panel, frame, NULL, frame_bytes, LV_DISPLAY_RENDER_MODE_DIRECT);
+    if (disp == NULL) {
+        s_ctx.frame = NULL;
+        heap_caps_free(frame);
+        return NULL;
+    }
+    lv_display_set_flush_cb(disp, lcd_flush_direct_cb);
+
+    ESP_LOGI(TAG, "Display %dx%d, direct mode: one %u-byte frame, dirty rows sent at the end of each frame",
+             LCD_H_RES, LCD_V_RES, (unsigned)frame_bytes);
+
+    return disp;
+#endif
+}
+#endif
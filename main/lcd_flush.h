@@ -0,0 +1,31 @@
+#pragma once
+
+#include <esp_lcd_panel_io.h>
+#include <esp_lcd_panel_ops.h>
+#include <lvgl.h>
+
+// on_color_trans_done handler for the LCD panel IO, passed in app_lcd_init()
+bool lcd_flush_on_color_trans_done(esp_lcd_panel_io_handle_t io, esp_lcd_panel_io_event_data_t *edata, void *user_ctx);
+
+// Create the LVGL display that renders into buf_lines-tall DMA band buffers and
+// flushes them to lcd_panel, recording render, flush-wait and DMA timings in
+// lcd_stats. If the buffers cannot be allocated the band height is halved down
+// to LCD_BUF_LINES. Must be called after LVGL is initialized, with the LVGL lock held.
+lv_display_t *lcd_flush_create(esp_lcd_panel_io_handle_t lcd_io, esp_lcd_panel_handle_t lcd_panel, int buf_lines);
+
+// Create the LVGL display in direct mode (LCD_DIRECT_MODE): LVGL keeps one
+// full frame in DMA-capable internal RAM and redraws only the dirty areas in
+// it, and only the rows they cover are sent, merged across areas. Needs
+// RGB565_SWAPPED rendering (lcd_pixel.h). Returns NULL if the frame cannot be
+// allocated, for the caller to fall back to lcd_flush_create(). Not for use
+// with lcd_solid or lcd_merge, which work on partial-mode bands.
+lv_display_t *lcd_flush_create_direct(esp_lcd_panel_io_handle_t lcd_io, esp_lcd_panel_handle_t lcd_panel);
+
+// Block until nothing is left on the SPI bus, so the last band, row span or
+// fill of the frame is on the panel. lv_refr_now() returns while the last
+// band may still be in flight.
+void lcd_flush_wait_idle(lv_display_t *disp);
+
+// lcd_solid_fill_cb_t for the display made by lcd_flush_create(): sends area as
+// one colour, LCD_SOLID_FILL_LINES rows at a time from a small DMA buffer
+void lcd_flush_fill(lv_display_t *disp, const lv_area_t *area, lv_color_t color);
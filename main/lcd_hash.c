@@ -0,0 +1,160 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <lvgl.h>
+
+#include "hardware.h"
+#include "lcd_hash.h"
+#include "lcd_stats.h"
+
+// Strips in the tallest possible flush, in either orientation
+#define LCD_HASH_MAX_STRIPS  ((LV_MAX(LCD_H_RES, LCD_V_RES) + LCD_HASH_STRIP_ROWS - 1) / LCD_HASH_STRIP_ROWS)
+
+typedef struct {
+    lv_area_t area;
+    uint32_t stamp;           // Last use, for replacement; 0 = free
+    uint32_t hash[LCD_HASH_MAX_STRIPS];
+} lcd_hash_entry_t;
+
+static lcd_hash_entry_t s_entries[LCD_HASH_ENTRIES];
+static uint32_t s_stamp;
+static bool s_enabled = true;
+static lcd_hash_info_t s_info;
+
+static bool lcd_hash_area_equal(const lv_area_t *a, const lv_area_t *b)
+{
+    return a->x1 == b->x1 && a->y1 == b->y1 && a->x2 == b->x2 && a->y2 == b->y2;
+}
+
+// FNV-1a over 32-bit words; an odd pixel at the end of a row is folded in alone
+static uint32_t lcd_hash_rows(const uint16_t *px, uint32_t count)
+{
+    const uint32_t *w = (const uint32_t *)px;
+    uint32_t h = 0x811c9dc5u;
+
+    for (uint32_t i = 0; i < count / 2; i++)
+    {
+        h = (h ^ w[i]) * 0x01000193u;
+    }
+    if (count & 1)
+    {
+        h = (h ^ px[count - 1]) * 0x01000193u;
+    }
+
+    return h;
+}
+
+// Drop every remembered area that area overlaps, except keep
+static void lcd_hash_forget_except(const lv_area_t *area, const lcd_hash_entry_t *keep)
+{
+    lv_area_t common;
+
+    for (int i = 0; i < LCD_HASH_ENTRIES; i++)
+    {
+        if (&s_entries[i] != keep && s_entries[i].stamp != 0 && lv_area_intersect(&common, &s_entries[i].area, area))
+        {
+            s_entries[i].stamp = 0;
+        }
+    }
+}
+
+bool lcd_hash_check(const lv_area_t *area, const uint16_t *px, lv_area_t *send)
+{
+    const int32_t w = lv_area_get_width(area);
+    const int32_t h = lv_area_get_height(area);
+    const int32_t strips = (h + LCD_HASH_STRIP_ROWS - 1) / LCD_HASH_STRIP_ROWS;
+    lcd_hash_entry_t *entry = NULL;
+    lcd_hash_entry_t *oldest = &s_entries[0];
+
+    *send = *area;
+    s_info.checked_bytes += (uint64_t)w * h * sizeof(uint16_t);
+    if (!s_enabled || strips > LCD_HASH_MAX_STRIPS)
+    {
+        lcd_hash_forget_except(area, NULL);
+        return true;
+    }
+
+    for (int i = 0; i < LCD_HASH_ENTRIES; i++)
+    {
+        if (s_entries[i].stamp != 0 && lcd_hash_area_equal(&s_entries[i].area, area))
+        {
+            entry = &s_entries[i];
+        }
+        if (s_entries[i].stamp < oldest->stamp)
+        {
+            oldest = &s_entries[i];
+        }
+    }
+    lcd_hash_forget_except(area, entry);
+
+    // First and last strip that differ from what the panel holds
+    int32_t first = -1;
+    int32_t last = -1;
+    for (int32_t s = 0; s < strips; s++)
+    {
+        const int32_t rows = LV_MIN(LCD_HASH_STRIP_ROWS, h - s * LCD_HASH_STRIP_ROWS);
+        const uint32_t hash = lcd_hash_rows(px + s * LCD_HASH_STRIP_ROWS * w, rows * w);
+
+        if (entry == NULL || entry->hash[s] != hash)
+        {
+            first = (first < 0) ? s : first;
+            last = s;
+        }
+        if (entry != NULL)
+        {
+            entry->hash[s] = hash;
+        }
+        else
+        {
+            oldest->hash[s] = hash;
+        }
+    }
+
+    if (entry == NULL)
+    {
+        entry = oldest;
+        entry->area = *area;
+    }
+    entry->stamp = ++s_stamp;
+
+    if (first < 0)
+    {
+        s_info.skipped++;
+        s_info.skipped_bytes += (uint64_t)w * h * sizeof(uint16_t);
+        lcd_stats_record(LCD_STATS_SKIP_BYTES, w * h * sizeof(uint16_t));
+        return false;
+    }
+
+    send->y1 = area->y1 + first * LCD_HASH_STRIP_ROWS;
+    send->y2 = LV_MIN(area->y1 + (last + 1) * LCD_HASH_STRIP_ROWS - 1, area->y2);
+    const uint32_t skip = w * (h - lv_area_get_height(send)) * sizeof(uint16_t);
+    if (skip != 0)
+    {
+        s_info.trimmed++;
+        s_info.skipped_bytes += skip;
+    }
+    lcd_stats_record(LCD_STATS_SKIP_BYTES, skip);
+
+    return true;
+}
+
+void lcd_hash_forget(const lv_area_t *area)
+{
+    lcd_hash_forget_except(area, NULL);
+}
+
+void lcd_hash_reset(void)
+{
+    memset(s_entries, 0, sizeof(s_entries));
+}
+
+void lcd_hash_set_enabled(bool enabled)
+{
+    s_enabled = enabled;
+    lcd_hash_reset();
+}
+
+void lcd_hash_get_info(lcd_hash_info_t *info)
+{
+    *info = s_info;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <lvgl.h>
+
+// Flush skipping by content hash (LCD_FLUSH_HASH). LVGL redraws whatever is
+// invalidated, even when a label was set to the text it already had or a
+// style to the colour it already had. The last LCD_HASH_ENTRIES flushed
+// areas keep one hash per LCD_HASH_STRIP_ROWS rows of what was sent. When
+// the same area is flushed again, unchanged strips at its top and bottom
+// are trimmed, and nothing is sent if no strip changed. Any other write that
+// overlaps a remembered area makes it forget that area.
+
+typedef struct {
+    uint64_t checked_bytes;   // Colour bytes of every flush that went through lcd_hash_check()
+    uint64_t skipped_bytes;   // Of those, not sent because they were already on the panel
+    uint32_t skipped;         // Flushes not sent at all
+    uint32_t trimmed;         // Flushes sent with fewer rows
+} lcd_hash_info_t;
+
+// Decide what of area, rendered as px (RGB565, rows of area's width), has to
+// go to the panel. Returns false if nothing does, otherwise sets send to the
+// rows that do, and remembers the content as being on the panel.
+bool lcd_hash_check(const lv_area_t *area, const uint16_t *px, lv_area_t *send);
+
+// area of the panel was written outside lcd_hash_check(), e.g. by a solid fill
+void lcd_hash_forget(const lv_area_t *area);
+
+// Forget everything, e.g. after the panel orientation changed
+void lcd_hash_reset(void);
+
+// Turn skipping off and on at runtime. While off every flush is sent whole
+// and nothing is remembered.
+void lcd_hash_set_enabled(bool enabled);
+
+void lcd_hash_get_info(lcd_hash_info_t *info);
@@ -0,0 +1,186 @@
+#include <stdio.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <esp_log.h>
+#include <esp_err.h>
+#include <esp_timer.h>
+#include <esp_lcd_panel_io.h>
+#include <esp_lcd_panel_commands.h>
+#include <lvgl.h>
+
+#include "hardware.h"
+#include "lcd.h"
+#include "lcd_idle.h"
+
+static const char *TAG = "lcd_idle";
+
+// ILI9341: no command for 5 ms after SLPOUT. The 120 ms it wants between
+// SLPOUT and the next SLPIN is covered by LCD_IDLE_TIMEOUT_MS.
+#define LCD_IDLE_SLPOUT_MS       5
+
+// Invalidation resumes a paused refresh timer, so while asleep it is kept
+// running with a period that never comes due instead
+#define LCD_IDLE_REFR_PARKED_MS  (24 * 60 * 60 * 1000)
+
+typedef struct {
+    lv_display_t *disp;
+    esp_lcd_panel_io_handle_t io;
+    lcd_idle_wait_cb_t wait_cb;   // Waits for the catch-up frame to reach the panel
+    lv_timer_t *check_timer;
+    lv_indev_t *indev;
+    lv_indev_read_cb_t read_cb;   // The indev's own read callback
+    uint32_t refr_period;         // Refresh period before sleep, restored on wake
+    uint32_t poll_period;         // Indev read period before sleep, polled indevs only
+    int brightness;               // Backlight before sleep
+    int64_t wake_start;           // esp_timer time of the waking press
+    bool asleep;
+    bool swallow;                 // Report released until the waking finger lifts
+    uint32_t sleeps;
+    uint32_t last_wake_us;
+    uint32_t max_wake_us;
+} lcd_idle_ctx_t;
+
+static lcd_idle_ctx_t s_ctx;
+
+static lv_timer_t *lcd_idle_poll_timer(void)
+{
+    if (s_ctx.indev == NULL || lv_indev_get_mode(s_ctx.indev) != LV_INDEV_MODE_TIMER)
+    {
+        return NULL;
+    }
+
+    return lv_indev_get_read_timer(s_ctx.indev);
+}
+
+static void lcd_idle_sleep(void)
+{
+    lv_timer_t *refr = lv_display_get_refr_timer(s_ctx.disp);
+    lv_timer_t *poll = lcd_idle_poll_timer();
+
+    s_ctx.refr_period = lv_timer_get_period(refr);
+    lv_timer_set_period(refr, LCD_IDLE_REFR_PARKED_MS);
+    if (poll != NULL)
+    {
+        s_ctx.poll_period = lv_timer_get_period(poll);
+        lv_timer_set_period(poll, LCD_IDLE_POLL_MS);
+    }
+    lv_timer_pause(s_ctx.check_timer);
+
+    // Dark first, so the panel going to sleep is never visible
+    s_ctx.brightness = lcd_display_brightness_get();
+    lcd_display_backlight_off();
+    esp_err_t e = esp_lcd_panel_io_tx_param(s_ctx.io, LCD_CMD_SLPIN, NULL, 0);
+    if (e != ESP_OK)
+    {
+        ESP_LOGW(TAG, "SLPIN failed: %s", esp_err_to_name(e));
+    }
+
+    s_ctx.asleep = true;
+    s_ctx.sleeps++;
+    ESP_LOGI(TAG, "No input for %d s, display asleep", LCD_IDLE_TIMEOUT_MS / 1000);
+}
+
+static void lcd_idle_wake_cb(void *arg)
+{
+    esp_err_t e = esp_lcd_panel_io_tx_param(s_ctx.io, LCD_CMD_SLPOUT, NULL, 0);
+    if (e != ESP_OK)
+    {
+        ESP_LOGW(TAG, "SLPOUT failed: %s", esp_err_to_name(e));
+    }
+    vTaskDelay(pdMS_TO_TICKS(LCD_IDLE_SLPOUT_MS));
+
+    lv_timer_t *poll = lcd_idle_poll_timer();
+    if (poll != NULL)
+    {
+        lv_timer_set_period(poll, s_ctx.poll_period);
+    }
+    lv_timer_set_period(lv_display_get_refr_timer(s_ctx.disp), s_ctx.refr_period);
+    lv_timer_set_period(s_ctx.check_timer, LCD_IDLE_TIMEOUT_MS);
+    lv_timer_resume(s_ctx.check_timer);
+    lv_display_trigger_activity(s_ctx.disp);
+    s_ctx.asleep = false;
+
+    // GRAM kept the old frame: only areas invalidated while asleep are sent.
+    // The backlight waits until the last band is off the bus.
+    const int64_t refr_start = esp_timer_get_time();
+    lv_refr_now(s_ctx.disp);
+    if (s_ctx.wait_cb != NULL)
+    {
+        s_ctx.wait_cb(s_ctx.disp);
+    }
+    const int64_t refr_end = esp_timer_get_time();
+
+    lcd_display_brightness_set(s_ctx.brightness);
+
+    s_ctx.last_wake_us = (uint32_t)(esp_timer_get_time() - s_ctx.wake_start);
+    if (s_ctx.last_wake_us > s_ctx.max_wake_us)
+    {
+        s_ctx.max_wake_us = s_ctx.last_wake_us;
+    }
+    ESP_LOGI(TAG, "Awake %lu us after the press (catch-up frame %lld us)",
+             (unsigned long)s_ctx.last_wake_us, (long long)(refr_end - refr_start));
+}
+
+static void lcd_idle_read_cb(lv_indev_t *indev, lv_indev_data_t *data)
+{
+    s_ctx.read_cb(indev, data);
+
+    if (data->state != LV_INDEV_STATE_PRESSED)
+    {
+        s_ctx.swallow = false;
+        return;
+    }
+
+    if (s_ctx.asleep && !s_ctx.swallow)
+    {
+        s_ctx.wake_start = esp_timer_get_time();
+        s_ctx.swallow = true;
+        lv_async_call(lcd_idle_wake_cb, NULL);
+    }
+    if (s_ctx.swallow)
+    {
+        data->state = LV_INDEV_STATE_RELEASED;
+    }
+}
+
+// Rescheduled for the moment the display would reach the timeout, so it
+// runs once per LCD_IDLE_TIMEOUT_MS at most
+static void lcd_idle_check_cb(lv_timer_t *timer)
+{
+    const uint32_t inactive = lv_display_get_inactive_time(s_ctx.disp);
+
+    if (inactive < LCD_IDLE_TIMEOUT_MS)
+    {
+        lv_timer_set_period(timer, LCD_IDLE_TIMEOUT_MS - inactive);
+        return;
+    }
+
+    lcd_idle_sleep();
+}
+
+void lcd_idle_init(lv_display_t *disp, esp_lcd_panel_io_handle_t io, lcd_idle_wait_cb_t wait_cb)
+{
+    s_ctx.disp = disp;
+    s_ctx.io = io;
+    s_ctx.wait_cb = wait_cb;
+    s_ctx.check_timer = lv_timer_create(lcd_idle_check_cb, LCD_IDLE_TIMEOUT_MS, NULL);
+
+    ESP_LOGI(TAG, "Display sleeps after %d s without input", LCD_IDLE_TIMEOUT_MS / 1000);
+}
+
+void lcd_idle_watch_indev(lv_indev_t *indev)
+{
+    s_ctx.indev = indev;
+    s_ctx.read_cb = lv_indev_get_read_cb(indev);
+    lv_indev_set_read_cb(indev, lcd_idle_read_cb);
+}
+
+void lcd_idle_get_info(lcd_idle_info_t *info)
+{
+    info->asleep = s_ctx.asleep;
+    info->sleeps = s_ctx.sleeps;
+    info->last_wake_us = s_ctx.last_wake_us;
+    info->max_wake_us = s_ctx.max_wake_us;
+}
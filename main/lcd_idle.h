@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <esp_lcd_panel_io.h>
+#include <lvgl.h>
+
+// Idle sleep (LCD_IDLE_SLEEP). After LCD_IDLE_TIMEOUT_MS without input the
+// backlight is switched off, the panel is sent SLPIN and the display's
+// refresh timer is parked, so the LVGL task only wakes for the app's own
+// lv_timers (countdown, WiFi bars). Screen changes made while asleep are
+// still invalidated and kept.
+//
+// The first press wakes the panel (SLPOUT), flushes only what changed while
+// asleep, since GRAM kept everything else, and lights the backlight. That
+// press is swallowed, so it does not also hit the widget under the finger.
+
+typedef struct {
+    bool asleep;
+    uint32_t sleeps;        // Times the screen went to sleep since boot
+    uint32_t last_wake_us;  // Press seen to first frame on screen, last wake
+    uint32_t max_wake_us;
+} lcd_idle_info_t;
+
+// Block until the frame LVGL last flushed is on the panel
+typedef void (*lcd_idle_wait_cb_t)(lv_display_t *disp);
+
+// Attach idle sleep to a display; io is where SLPIN/SLPOUT are sent. wait_cb
+// runs after the catch-up frame, before the backlight comes back on; NULL
+// when flushes complete before lv_display_flush_ready() returns.
+void lcd_idle_init(lv_display_t *disp, esp_lcd_panel_io_handle_t io, lcd_idle_wait_cb_t wait_cb);
+
+// Wake on presses from indev. With a touch IRQ the indev is read on the
+// interrupt as usual, otherwise it is polled every LCD_IDLE_POLL_MS while asleep
+void lcd_idle_watch_indev(lv_indev_t *indev);
+
+void lcd_idle_get_info(lcd_idle_info_t *info);
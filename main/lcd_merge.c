@@ -0,0 +1,124 @@
+#include <stdio.h>
+
+#include <esp_log.h>
+#include <lvgl.h>
+#include <src/display/lv_display_private.h>
+
+#include "hardware.h"
+#include "lcd_bus_cost.h"
+#include "lcd_merge.h"
+
+static const char *TAG = "lcd_merge";
+
+typedef struct {
+    bool enabled;
+    uint32_t frames;
+    uint32_t merges;
+    uint64_t saved_ns;
+} lcd_merge_ctx_t;
+
+static lcd_merge_ctx_t s_ctx = { .enabled = true };
+
+static uint32_t lcd_merge_cost_ns(const lv_area_t *area, uint32_t buf_px)
+{
+    return lcd_bus_cost_partial(lv_area_get_width(area), lv_area_get_height(area), buf_px).time_ns;
+}
+
+// Greedy: merge the pair that saves the most until no pair saves anything.
+// The box goes into the later slot, so the last area LVGL picked before
+// LV_EVENT_RENDER_START is still the last one drawn.
+static void lcd_merge_areas(lv_display_t *disp)
+{
+    const uint32_t buf_px = disp->buf_1->data_size / lv_color_format_get_size(lv_display_get_color_format(disp));
+    uint32_t cost[LV_INV_BUF_SIZE];
+    uint32_t merges = 0;
+
+    for (uint32_t i = 0; i < disp->inv_p; i++)
+    {
+        cost[i] = disp->inv_area_joined[i] ? 0 : lcd_merge_cost_ns(&disp->inv_areas[i], buf_px);
+    }
+
+    for (;;)
+    {
+        int64_t best_saving = 0;
+        uint32_t best_i = 0;
+        uint32_t best_j = 0;
+        uint32_t best_cost = 0;
+        lv_area_t best_box;
+
+        for (uint32_t i = 0; i < disp->inv_p; i++)
+        {
+            if (disp->inv_area_joined[i])
+            {
+                continue;
+            }
+
+            for (uint32_t j = i + 1; j < disp->inv_p; j++)
+            {
+                if (disp->inv_area_joined[j])
+                {
+                    continue;
+                }
+
+                lv_area_t box;
+                lv_area_join(&box, &disp->inv_areas[i], &disp->inv_areas[j]);
+                const uint32_t box_cost = lcd_merge_cost_ns(&box, buf_px);
+                const int64_t saving = (int64_t)cost[i] + cost[j] - box_cost;
+
+                if (saving > best_saving)
+                {
+                    best_saving = saving;
+                    best_i = i;
+                    best_j = j;
+                    best_cost = box_cost;
+                    best_box = box;
+                }
+            }
+        }
+
+        if (best_saving <= 0)
+        {
+            break;
+        }
+
+        disp->inv_areas[best_j] = best_box;
+        cost[best_j] = best_cost;
+        disp->inv_area_joined[best_i] = 1;
+        s_ctx.saved_ns += best_saving;
+        merges++;
+    }
+
+    if (merges > 0)
+    {
+        s_ctx.frames++;
+        s_ctx.merges += merges;
+    }
+}
+
+static void lcd_merge_event_cb(lv_event_t *e)
+{
+    if (s_ctx.enabled)
+    {
+        lcd_merge_areas(lv_event_get_target(e));
+    }
+}
+
+void lcd_merge_init(lv_display_t *disp)
+{
+    // Sent after LVGL has joined the areas and before the first one is drawn
+    lv_display_add_event_cb(disp, lcd_merge_event_cb, LV_EVENT_RENDER_START, NULL);
+
+    ESP_LOGI(TAG, "Dirty areas merged by bus cost at %lu Hz", (unsigned long)lcd_bus_cost_get_pclk());
+}
+
+void lcd_merge_set_enabled(bool enabled)
+{
+    s_ctx.enabled = enabled;
+}
+
+void lcd_merge_get_info(lcd_merge_info_t *info)
+{
+    info->frames = s_ctx.frames;
+    info->merges = s_ctx.merges;
+    info->saved_ns = s_ctx.saved_ns;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <lvgl.h>
+
+// Dirty-area merging by SPI bus cost (LCD_MERGE_COST_MODEL). LVGL only joins
+// invalidated areas that touch, and only when that saves pixels. Every area it
+// keeps separate costs its own CASET/PASET/RAMWR sequences per chunk, so when
+// the countdown, the WiFi bars and the button change in the same frame the
+// command overhead adds up. Before rendering, this pass joins pairs of areas
+// into their bounding box while lcd_bus_cost_partial() says one flush of the
+// box is cheaper than flushing both.
+
+typedef struct {
+    uint32_t frames;      // Frames where at least one pair was merged
+    uint32_t merges;      // Pairs merged since boot
+    uint64_t saved_ns;    // Modelled bus time saved by the merges
+} lcd_merge_info_t;
+
+// Attach the merge pass to a partial-mode display
+void lcd_merge_init(lv_display_t *disp);
+
+// Turn the pass off and on at runtime, to compare bus time with and without it
+void lcd_merge_set_enabled(bool enabled);
+
+void lcd_merge_get_info(lcd_merge_info_t *info);
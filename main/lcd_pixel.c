@@ -0,0 +1,47 @@
+#include <stdint.h>
+
+#include "lcd_pixel.h"
+
+// Swap the bytes of both 16-bit halves of a word
+static inline uint32_t lcd_pixel_swap2(uint32_t w)
+{
+    return ((w >> 8) & 0x00FF00FFu) | ((w << 8) & 0xFF00FF00u);
+}
+
+void lcd_pixel_swap_rgb565(void *buf, uint32_t px)
+{
+    uint16_t *p16 = (uint16_t *)buf;
+
+    if (px == 0) {
+        return;
+    }
+
+    // Leading pixel to reach 32-bit alignment
+    if ((uintptr_t)p16 & 2) {
+        *p16 = (uint16_t)((*p16 >> 8) | (*p16 << 8));
+        p16++;
+        px--;
+    }
+
+    uint32_t *p32 = (uint32_t *)p16;
+    uint32_t words = px / 2;
+
+    while (words >= 4) {
+        p32[0] = lcd_pixel_swap2(p32[0]);
+        p32[1] = lcd_pixel_swap2(p32[1]);
+        p32[2] = lcd_pixel_swap2(p32[2]);
+        p32[3] = lcd_pixel_swap2(p32[3]);
+        p32 += 4;
+        words -= 4;
+    }
+    while (words--) {
+        *p32 = lcd_pixel_swap2(*p32);
+        p32++;
+    }
+
+    // Trailing odd pixel
+    if (px & 1) {
+        p16 = (uint16_t *)p32;
+        *p16 = (uint16_t)((*p16 >> 8) | (*p16 << 8));
+    }
+}
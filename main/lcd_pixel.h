@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <lvgl.h>
+
+#include "hardware.h"
+
+// Render straight into panel byte order when LCD_RENDER_SWAPPED is set and the
+// LVGL build can draw RGB565_SWAPPED; otherwise render RGB565 and swap at flush.
+#if LCD_RENDER_SWAPPED && defined(LV_DRAW_SW_SUPPORT_RGB565_SWAPPED) && LV_DRAW_SW_SUPPORT_RGB565_SWAPPED
+#define LCD_PIXEL_NATIVE_SWAPPED    1
+#define LCD_PIXEL_RENDER_FORMAT     LV_COLOR_FORMAT_RGB565_SWAPPED
+#else
+#define LCD_PIXEL_NATIVE_SWAPPED    0
+#define LCD_PIXEL_RENDER_FORMAT     LV_COLOR_FORMAT_RGB565
+#endif
+
+// Convert RGB565 pixels between CPU (little-endian) and panel (big-endian) byte
+// order in place. Works on 32-bit words, two pixels at a time.
+void lcd_pixel_swap_rgb565(void *buf, uint32_t px);
@@ -0,0 +1,168 @@
+#include <stdio.h>
+
+#include <esp_log.h>
+#include <lvgl.h>
+#if LV_USE_PERF_MONITOR
+#include <src/display/lv_display_private.h>
+#endif
+
+#include "hardware.h"
+#include "lcd_refresh.h"
+
+static const char *TAG = "lcd_refresh";
+
+typedef struct {
+    lv_display_t *disp;
+    uint32_t period_ms;
+    uint32_t last_active;     // lv_tick of the last refresh that saw input or animation
+    bool active;
+    uint32_t window_start;    // lv_tick at the start of the FPS window
+    uint32_t window_frames;
+    uint32_t fps;
+    uint32_t switches;
+} lcd_refresh_ctx_t;
+
+static lcd_refresh_ctx_t s_ctx;
+
+static bool lcd_refresh_input_or_anim(void)
+{
+    if (lv_anim_count_running() > 0)
+    {
+        return true;
+    }
+
+    for (lv_indev_t *indev = lv_indev_get_next(NULL); indev != NULL; indev = lv_indev_get_next(indev))
+    {
+        // A scroll object stays set through the throw after release
+        if (lv_indev_get_state(indev) == LV_INDEV_STATE_PRESSED || lv_indev_get_scroll_obj(indev) != NULL)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Frames rendered over the last second
+static uint32_t lcd_refresh_fps(void)
+{
+    const uint32_t elapsed = lv_tick_elaps(s_ctx.window_start);
+
+    // Nothing rendered for a while: the last full window is stale
+    return (elapsed >= 1000) ? s_ctx.window_frames * 1000 / elapsed : s_ctx.fps;
+}
+
+static void lcd_refresh_set_period(uint32_t period_ms)
+{
+    if (period_ms == s_ctx.period_ms)
+    {
+        return;
+    }
+
+    lv_timer_set_period(lv_display_get_refr_timer(s_ctx.disp), period_ms);
+    s_ctx.period_ms = period_ms;
+    s_ctx.switches++;
+    // At most two lines per touch; the perf monitor is off in the default build
+    ESP_LOGI(TAG, "Refresh period %u ms (%s), %u fps before the switch", (unsigned)period_ms,
+             s_ctx.active ? "input/animation" : "timers only", (unsigned)lcd_refresh_fps());
+}
+
+static void lcd_refresh_update(void)
+{
+    const uint32_t now = lv_tick_get();
+
+    if (lcd_refresh_input_or_anim())
+    {
+        s_ctx.last_active = now;
+        s_ctx.active = true;
+    }
+    else if (s_ctx.active && lv_tick_elaps(s_ctx.last_active) >= LCD_REFR_HOLD_MS)
+    {
+        s_ctx.active = false;
+    }
+
+    lcd_refresh_set_period(s_ctx.active ? LCD_REFR_PERIOD_FAST_MS : LCD_REFR_PERIOD_IDLE_MS);
+}
+
+static void lcd_refresh_count_frame(void)
+{
+    const uint32_t elapsed = lv_tick_elaps(s_ctx.window_start);
+
+    if (elapsed >= 1000)
+    {
+        s_ctx.fps = s_ctx.window_frames * 1000 / elapsed;
+        s_ctx.window_frames = 0;
+        s_ctx.window_start = lv_tick_get();
+    }
+    s_ctx.window_frames++;
+}
+
+static void lcd_refresh_event_cb(lv_event_t *e)
+{
+    switch (lv_event_get_code(e))
+    {
+    case LV_EVENT_REFR_START:
+        lcd_refresh_update();
+        break;
+    case LV_EVENT_RENDER_START:
+        lcd_refresh_count_frame();
+        break;
+    default:
+        break;
+    }
+}
+
+static void lcd_refresh_indev_event_cb(lv_event_t *e)
+{
+    s_ctx.last_active = lv_tick_get();
+    s_ctx.active = true;
+    lcd_refresh_set_period(LCD_REFR_PERIOD_FAST_MS);
+}
+
+#if LV_USE_PERF_MONITOR
+// Runs after LVGL's own perf monitor observer has written the label
+static void lcd_refresh_perf_observer_cb(lv_observer_t *observer, lv_subject_t *subject)
+{
+    lv_obj_t *label = lv_observer_get_target_obj(observer);
+    char text[128];
+
+    // lv_label_set_text_fmt() frees the old text before formatting, so it
+    // cannot be passed as an argument
+    snprintf(text, sizeof(text), "%s\n%u ms refr, %s", lv_label_get_text(label),
+             (unsigned)s_ctx.period_ms, s_ctx.active ? "fast" : "idle");
+    lv_label_set_text(label, text);
+}
+#endif
+
+void lcd_refresh_governor_init(lv_display_t *disp)
+{
+    s_ctx.disp = disp;
+    s_ctx.period_ms = lv_timer_get_period(lv_display_get_refr_timer(disp));
+    s_ctx.window_start = lv_tick_get();
+
+    lv_display_add_event_cb(disp, lcd_refresh_event_cb, LV_EVENT_REFR_START, NULL);
+    lv_display_add_event_cb(disp, lcd_refresh_event_cb, LV_EVENT_RENDER_START, NULL);
+    lcd_refresh_set_period(LCD_REFR_PERIOD_IDLE_MS);
+
+#if LV_USE_PERF_MONITOR
+    if (disp->perf_label != NULL)
+    {
+        lv_subject_add_observer_obj(&disp->perf_sysmon_backend.subject, lcd_refresh_perf_observer_cb, disp->perf_label, NULL);
+    }
+#endif
+
+    ESP_LOGI(TAG, "Refresh governor: %d ms with input/animation, %d ms otherwise", LCD_REFR_PERIOD_FAST_MS, LCD_REFR_PERIOD_IDLE_MS);
+}
+
+void lcd_refresh_governor_watch_indev(lv_indev_t *indev)
+{
+    lv_indev_add_event_cb(indev, lcd_refresh_indev_event_cb, LV_EVENT_PRESSED, NULL);
+}
+
+void lcd_refresh_get_info(lcd_refresh_info_t *info)
+{
+    info->period_ms = s_ctx.period_ms;
+    info->active = s_ctx.active;
+    info->fps = lcd_refresh_fps();
+    info->switches = s_ctx.switches;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <lvgl.h>
+
+// Adaptive refresh-rate governor. At the start of every refresh the period of
+// the display's refresh timer is set to LCD_REFR_PERIOD_FAST_MS while a touch
+// is pressed, a scroll is in progress or an animation runs (and for
+// LCD_REFR_HOLD_MS after), and to LCD_REFR_PERIOD_IDLE_MS when only lv_timers
+// such as the countdown change the screen.
+
+typedef struct {
+    uint32_t period_ms;  // Refresh period currently chosen
+    bool active;         // Input or animation seen within LCD_REFR_HOLD_MS
+    uint32_t fps;        // Frames actually rendered over the last second
+    uint32_t switches;   // Rate changes since boot
+} lcd_refresh_info_t;
+
+// Attach the governor to a display. Every rate switch is logged at INFO with
+// the frame rate before it. With LV_USE_PERF_MONITOR the chosen period is
+// also appended to the perf monitor label, next to LVGL's FPS figure.
+void lcd_refresh_governor_init(lv_display_t *disp);
+
+// Switch to the fast rate as soon as indev reports a press, rather than on
+// the next refresh
+void lcd_refresh_governor_watch_indev(lv_indev_t *indev);
+
+void lcd_refresh_get_info(lcd_refresh_info_t *info);
@@ -0,0 +1,82 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "lcd_bus_cost.h"
+#include "lcd_rows.h"
+
+// Join span i + 1 into span i
+static void lcd_rows_join(lcd_rows_t *rows, int i)
+{
+    rows->span[i].y1 = (rows->span[i + 1].y1 < rows->span[i].y1) ? rows->span[i + 1].y1 : rows->span[i].y1;
+    rows->span[i].y2 = (rows->span[i + 1].y2 > rows->span[i].y2) ? rows->span[i + 1].y2 : rows->span[i].y2;
+    memmove(&rows->span[i + 1], &rows->span[i + 2], (rows->count - i - 2) * sizeof(rows->span[0]));
+    rows->count--;
+}
+
+// One transfer of span i and i + 1 together is no dearer than two
+static int lcd_rows_cheaper_joined(const lcd_rows_t *rows, int i)
+{
+    const lcd_rows_span_t *a = &rows->span[i];
+    const lcd_rows_span_t *b = &rows->span[i + 1];
+
+    if (b->y1 <= a->y2 + 1)
+    {
+        return 1;
+    }
+
+    const uint32_t apart = lcd_bus_cost_area(rows->width, a->y2 - a->y1 + 1).time_ns
+                         + lcd_bus_cost_area(rows->width, b->y2 - b->y1 + 1).time_ns;
+    const uint32_t joined = lcd_bus_cost_area(rows->width, b->y2 - a->y1 + 1).time_ns;
+
+    return joined <= apart;
+}
+
+void lcd_rows_reset(lcd_rows_t *rows, int32_t width)
+{
+    rows->width = width;
+    rows->count = 0;
+}
+
+void lcd_rows_add(lcd_rows_t *rows, int32_t y1, int32_t y2)
+{
+    if (rows->count == LCD_ROWS_MAX_SPANS)
+    {
+        // Make room by joining the pair with the fewest rows between them
+        int best = 0;
+        for (int i = 1; i < rows->count - 1; i++)
+        {
+            if (rows->span[i + 1].y1 - rows->span[i].y2 < rows->span[best + 1].y1 - rows->span[best].y2)
+            {
+                best = i;
+            }
+        }
+        lcd_rows_join(rows, best);
+    }
+
+    int at = 0;
+    while (at < rows->count && rows->span[at].y1 < y1)
+    {
+        at++;
+    }
+    memmove(&rows->span[at + 1], &rows->span[at], (rows->count - at) * sizeof(rows->span[0]));
+    rows->span[at].y1 = y1;
+    rows->span[at].y2 = y2;
+    rows->count++;
+
+    // Sorted by y1, so only neighbours can overlap; a join may enable another
+    for (int i = (at > 0) ? at - 1 : 0; i < rows->count - 1;)
+    {
+        if (lcd_rows_cheaper_joined(rows, i))
+        {
+            lcd_rows_join(rows, i);
+        }
+        else if (i >= at)
+        {
+            break;
+        }
+        else
+        {
+            i++;
+        }
+    }
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdint.h>
+
+// Dirty rows of a direct-mode frame (LCD_DIRECT_MODE). With a full frame in
+// RAM, rows are contiguous, so each refreshed area is sent as the full-width
+// rows it covers: one CASET/PASET/RAMWR for however many areas share them.
+// Spans are merged while lcd_bus_cost_area() says one transfer of the union
+// is no dearer than both, so in practice only touching spans join.
+
+#define LCD_ROWS_MAX_SPANS  8
+
+typedef struct {
+    int32_t y1;
+    int32_t y2;
+} lcd_rows_span_t;
+
+typedef struct {
+    int32_t width;          // Row width in pixels, the display's horizontal resolution
+    int count;
+    lcd_rows_span_t span[LCD_ROWS_MAX_SPANS];  // Sorted, not overlapping
+} lcd_rows_t;
+
+// Start a frame of width-pixel rows
+void lcd_rows_reset(lcd_rows_t *rows, int32_t width);
+
+// Mark rows [y1, y2] dirty. When all spans are in use the two closest are joined.
+void lcd_rows_add(lcd_rows_t *rows, int32_t y1, int32_t y2);
@@ -0,0 +1,335 @@
+#include <stdio.h>
+
+#include <esp_log.h>
+#include <lvgl.h>
+#include <src/display/lv_display_private.h>
+
+#include "hardware.h"
+#include "lcd_solid.h"
+
+static const char *TAG = "lcd_solid";
+
+typedef struct {
+    lcd_solid_fill_cb_t fill_cb;
+    bool enabled;
+    int32_t last;                    // The slot LVGL will flush as the frame's last area
+    bool pending[LV_INV_BUF_SIZE];   // Areas of this frame not split yet
+    uint32_t fills;
+    uint64_t pixels;
+} lcd_solid_ctx_t;
+
+static lcd_solid_ctx_t s_ctx = { .enabled = true };
+
+static bool lcd_solid_transformed(lv_obj_t *obj)
+{
+    return lv_obj_get_style_transform_rotation(obj, LV_PART_MAIN) != 0 ||
+           lv_obj_get_style_transform_scale_x(obj, LV_PART_MAIN) != LV_SCALE_NONE ||
+           lv_obj_get_style_transform_scale_y(obj, LV_PART_MAIN) != LV_SCALE_NONE;
+}
+
+// The object that decides every pixel of area: the topmost one that covers it
+// whole. NULL if something drawn in area only covers part of it.
+static lv_obj_t *lcd_solid_top_obj(lv_obj_t *obj, const lv_area_t *area)
+{
+    if (lcd_solid_transformed(obj))
+    {
+        return NULL;
+    }
+
+    for (int32_t i = (int32_t)lv_obj_get_child_count(obj) - 1; i >= 0; i--)
+    {
+        lv_obj_t *child = lv_obj_get_child(obj, i);
+        lv_area_t coords;
+        lv_area_t ext;
+        lv_area_t common;
+
+        if (lv_obj_has_flag(child, LV_OBJ_FLAG_HIDDEN))
+        {
+            continue;
+        }
+
+        lv_obj_get_coords(child, &coords);
+        ext = coords;
+        lv_area_increase(&ext, lv_obj_get_ext_draw_size(child), lv_obj_get_ext_draw_size(child));
+        if (!lv_area_intersect(&common, &ext, area))
+        {
+            continue;
+        }
+
+        return lv_area_is_in(area, &coords, 0) ? lcd_solid_top_obj(child, area) : NULL;
+    }
+
+    return obj;
+}
+
+// Nothing on a top or system layer (message boxes, perf monitor) reaches area
+static bool lcd_solid_layer_clear(lv_obj_t *layer, const lv_area_t *area)
+{
+    for (uint32_t i = 0; i < lv_obj_get_child_count(layer); i++)
+    {
+        lv_obj_t *child = lv_obj_get_child(layer, i);
+        lv_area_t ext;
+        lv_area_t common;
+
+        if (lv_obj_has_flag(child, LV_OBJ_FLAG_HIDDEN))
+        {
+            continue;
+        }
+
+        lv_obj_get_coords(child, &ext);
+        lv_area_increase(&ext, lv_obj_get_ext_draw_size(child), lv_obj_get_ext_draw_size(child));
+        if (lv_area_intersect(&common, &ext, area))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// obj is a plain lv_obj that draws nothing in area but an opaque, flat background
+static bool lcd_solid_plain(lv_obj_t *obj, const lv_area_t *area)
+{
+    // Widgets and objects with a draw callback (countdown_widget.c) draw more than their background
+    if (!lv_obj_check_type(obj, &lv_obj_class) || lv_obj_get_event_count(obj) > 0)
+    {
+        return false;
+    }
+
+    if (lv_obj_get_style_opa_recursive(obj, LV_PART_MAIN) < LV_OPA_MAX ||
+        lv_obj_get_style_bg_opa(obj, LV_PART_MAIN) < LV_OPA_MAX ||
+        lv_obj_get_style_bg_grad_dir(obj, LV_PART_MAIN) != LV_GRAD_DIR_NONE ||
+        lv_obj_get_style_bg_image_src(obj, LV_PART_MAIN) != NULL ||
+        lv_obj_get_style_blend_mode(obj, LV_PART_MAIN) != LV_BLEND_MODE_NORMAL ||
+        (lv_obj_get_style_color_filter_dsc(obj, LV_PART_MAIN) != NULL &&
+         lv_obj_get_style_color_filter_opa(obj, LV_PART_MAIN) > LV_OPA_MIN))
+    {
+        return false;
+    }
+
+    // An outline pulled inside the object
+    if (lv_obj_get_style_outline_width(obj, LV_PART_MAIN) > 0 &&
+        lv_obj_get_style_outline_opa(obj, LV_PART_MAIN) > LV_OPA_MIN &&
+        lv_obj_get_style_outline_pad(obj, LV_PART_MAIN) < 0)
+    {
+        return false;
+    }
+
+    lv_area_t inner;
+    lv_obj_get_coords(obj, &inner);
+
+    if (lv_obj_get_style_border_width(obj, LV_PART_MAIN) > 0 &&
+        lv_obj_get_style_border_opa(obj, LV_PART_MAIN) > LV_OPA_MIN &&
+        lv_obj_get_style_border_side(obj, LV_PART_MAIN) != LV_BORDER_SIDE_NONE)
+    {
+        const int32_t bw = lv_obj_get_style_border_width(obj, LV_PART_MAIN);
+        lv_area_increase(&inner, -bw, -bw);
+    }
+
+    // Rounded corners only touch the r x r squares at the corners
+    int32_t r = lv_obj_get_style_radius(obj, LV_PART_MAIN);
+    r = LV_MIN(r, LV_MIN(lv_area_get_width(&inner), lv_area_get_height(&inner)) / 2);
+    lv_area_t band_h = inner;
+    lv_area_t band_v = inner;
+    lv_area_increase(&band_h, -r, 0);
+    lv_area_increase(&band_v, 0, -r);
+    if (!lv_area_is_in(area, &band_h, 0) && !lv_area_is_in(area, &band_v, 0))
+    {
+        return false;
+    }
+
+    lv_area_t hor;
+    lv_area_t ver;
+    lv_area_t common;
+    lv_obj_get_scrollbar_area(obj, &hor, &ver);
+
+    return !lv_area_intersect(&common, &hor, area) && !lv_area_intersect(&common, &ver, area);
+}
+
+static bool lcd_solid_color(lv_display_t *disp, const lv_area_t *area, lv_color_t *color)
+{
+    if (!lcd_solid_layer_clear(lv_display_get_layer_top(disp), area) ||
+        !lcd_solid_layer_clear(lv_display_get_layer_sys(disp), area))
+    {
+        return false;
+    }
+
+    lv_obj_t *obj = lcd_solid_top_obj(lv_display_get_screen_active(disp), area);
+    if (obj == NULL || !lcd_solid_plain(obj, area))
+    {
+        return false;
+    }
+
+    *color = lv_obj_get_style_bg_color(obj, LV_PART_MAIN);
+    return true;
+}
+
+// A slot up to the last one whose area was joined or filled, for another run
+static int32_t lcd_solid_free_slot(lv_display_t *disp)
+{
+    for (int32_t j = 0; j <= s_ctx.last; j++)
+    {
+        if (disp->inv_area_joined[j] && !s_ctx.pending[j])
+        {
+            return j;
+        }
+    }
+
+    return -1;
+}
+
+// Hand rows [y1, y2] of area back to LVGL: in the area's own slot first,
+// then in free slots. LVGL has already picked the last slot it will flush,
+// so runs are never appended after it. With no slot left the previous run is
+// stretched down, rendering the filled strips in between again.
+static void lcd_solid_keep(lv_display_t *disp, uint32_t i, int32_t y1, int32_t y2, int32_t *last_slot)
+{
+    lv_area_t run = disp->inv_areas[i];
+    run.y1 = y1;
+    run.y2 = y2;
+
+    const int32_t slot = (*last_slot < 0) ? (int32_t)i : lcd_solid_free_slot(disp);
+    if (slot >= 0)
+    {
+        *last_slot = slot;
+        disp->inv_area_joined[slot] = 0;
+    }
+    else
+    {
+        run.y1 = disp->inv_areas[*last_slot].y1;
+    }
+
+    disp->inv_areas[*last_slot] = run;
+}
+
+// LVGL flags the area in slot last as the frame's last one. If that area was
+// filled whole, the highest remaining run moves into it.
+static void lcd_solid_keep_last(lv_display_t *disp)
+{
+    if (!disp->inv_area_joined[s_ctx.last])
+    {
+        return;
+    }
+
+    for (int32_t j = s_ctx.last - 1; j >= 0; j--)
+    {
+        if (!disp->inv_area_joined[j])
+        {
+            disp->inv_areas[s_ctx.last] = disp->inv_areas[j];
+            disp->inv_area_joined[s_ctx.last] = 0;
+            disp->inv_area_joined[j] = 1;
+            return;
+        }
+    }
+}
+
+// Cut area i into strips of the rows LVGL renders per band, fill the solid
+// ones and leave the rest for LVGL
+static void lcd_solid_split(lv_display_t *disp, uint32_t i, uint32_t buf_px)
+{
+    const lv_area_t area = disp->inv_areas[i];
+    const int32_t rows = LV_MAX(1, (int32_t)(buf_px / lv_area_get_width(&area)));
+    int32_t run_y1 = -1;
+    int32_t last_slot = -1;
+    bool filled = false;
+
+    for (int32_t y = area.y1; y <= area.y2; y += rows)
+    {
+        lv_area_t strip = area;
+        lv_color_t color;
+
+        strip.y1 = y;
+        strip.y2 = LV_MIN(y + rows - 1, area.y2);
+
+        if (!lcd_solid_color(disp, &strip, &color))
+        {
+            run_y1 = (run_y1 < 0) ? y : run_y1;
+            continue;
+        }
+
+        if (run_y1 >= 0)
+        {
+            lcd_solid_keep(disp, i, run_y1, y - 1, &last_slot);
+            run_y1 = -1;
+        }
+
+        s_ctx.fill_cb(disp, &strip, color);
+        s_ctx.fills++;
+        s_ctx.pixels += lv_area_get_size(&strip);
+        filled = true;
+    }
+
+    if (!filled)
+    {
+        return;
+    }
+
+    if (run_y1 >= 0)
+    {
+        lcd_solid_keep(disp, i, run_y1, area.y2, &last_slot);
+    }
+    if (last_slot < 0)
+    {
+        disp->inv_area_joined[i] = 1;
+    }
+}
+
+static void lcd_solid_event_cb(lv_event_t *e)
+{
+    lv_display_t *disp = lv_event_get_target(e);
+
+    // Screen load animations draw two screens at once
+    if (!s_ctx.enabled || lv_display_get_screen_prev(disp) != NULL)
+    {
+        return;
+    }
+
+    const uint32_t buf_px = disp->buf_1->data_size / lv_color_format_get_size(lv_display_get_color_format(disp));
+
+    // Same choice as refr_invalid_areas() made before sending RENDER_START
+    s_ctx.last = 0;
+    for (int32_t i = (int32_t)disp->inv_p - 1; i >= 0; i--)
+    {
+        if (!disp->inv_area_joined[i])
+        {
+            s_ctx.last = i;
+            break;
+        }
+    }
+
+    for (int32_t i = 0; i <= s_ctx.last; i++)
+    {
+        s_ctx.pending[i] = !disp->inv_area_joined[i];
+    }
+    for (int32_t i = 0; i <= s_ctx.last; i++)
+    {
+        if (s_ctx.pending[i])
+        {
+            s_ctx.pending[i] = false;
+            lcd_solid_split(disp, i, buf_px);
+        }
+    }
+
+    lcd_solid_keep_last(disp);
+}
+
+void lcd_solid_init(lv_display_t *disp, lcd_solid_fill_cb_t fill_cb)
+{
+    s_ctx.fill_cb = fill_cb;
+
+    // Sent after LVGL has joined the areas and before the first one is drawn
+    lv_display_add_event_cb(disp, lcd_solid_event_cb, LV_EVENT_RENDER_START, NULL);
+
+    ESP_LOGI(TAG, "Solid strips sent as fills, %d lines per fill chunk", LCD_SOLID_FILL_LINES);
+}
+
+void lcd_solid_set_enabled(bool enabled)
+{
+    s_ctx.enabled = enabled;
+}
+
+void lcd_solid_get_info(lcd_solid_info_t *info)
+{
+    info->fills = s_ctx.fills;
+    info->pixels = s_ctx.pixels;
+}
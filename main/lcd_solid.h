@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <lvgl.h>
+
+// Solid-fill fast path (LCD_SOLID_FILL). Before rendering, every dirty area
+// is cut into the strips LVGL would render as one band. A strip where the
+// only thing drawn is the plain background of one opaque object (no children,
+// text, images, gradients, borders or rounded corners reaching into it) is
+// taken out of LVGL's list and handed to fill_cb with that colour instead,
+// so it is never rendered into a draw buffer.
+
+// Send area, in display coordinates, to the panel as one colour. Called at
+// LV_EVENT_RENDER_START, before the first band of the frame is flushed.
+typedef void (*lcd_solid_fill_cb_t)(lv_display_t *disp, const lv_area_t *area, lv_color_t color);
+
+typedef struct {
+    uint32_t fills;     // Strips sent through fill_cb since boot
+    uint64_t pixels;    // Pixels in those strips
+} lcd_solid_info_t;
+
+// Attach the fast path to a partial-mode display
+void lcd_solid_init(lv_display_t *disp, lcd_solid_fill_cb_t fill_cb);
+
+// Turn the fast path off and on at runtime, for benchmarks
+void lcd_solid_set_enabled(bool enabled);
+
+void lcd_solid_get_info(lcd_solid_info_t *info);
@@ -0,0 +1,117 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+
+#include <esp_attr.h>
+#include <esp_log.h>
+
+#include "lcd_stats.h"
+
+static const char *TAG = "lcd_stats";
+
+static const char *const s_metric_names[LCD_STATS_METRIC_MAX] = {
+    [LCD_STATS_RENDER_US]     = "render_us",
+    [LCD_STATS_FLUSH_WAIT_US] = "flush_wait_us",
+    [LCD_STATS_DMA_US]        = "dma_us",
+    [LCD_STATS_FLUSH_BYTES]   = "flush_bytes",
+    [LCD_STATS_FLUSH_AREA]    = "flush_area_px",
+    [LCD_STATS_OVERLAP_US]    = "overlap_us",
+    [LCD_STATS_FILL_AREA]     = "fill_area_px",
+    [LCD_STATS_SKIP_BYTES]    = "skip_bytes",
+};
+
+static lcd_stats_hist_t s_hist[LCD_STATS_METRIC_MAX];
+static portMUX_TYPE s_hist_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static inline uint32_t lcd_stats_bucket(uint32_t value)
+{
+    uint32_t bucket = (value == 0) ? 0 : 32 - __builtin_clz(value);
+
+    return (bucket < LCD_STATS_HIST_BUCKETS) ? bucket : LCD_STATS_HIST_BUCKETS - 1;
+}
+
+void IRAM_ATTR lcd_stats_record(lcd_stats_metric_t metric, uint32_t value)
+{
+    if (metric >= LCD_STATS_METRIC_MAX) {
+        return;
+    }
+
+    lcd_stats_hist_t *hist = &s_hist[metric];
+
+    portENTER_CRITICAL_SAFE(&s_hist_lock);
+    if (hist->count == 0 || value < hist->min) {
+        hist->min = value;
+    }
+    if (value > hist->max) {
+        hist->max = value;
+    }
+    hist->count++;
+    hist->sum += value;
+    hist->buckets[lcd_stats_bucket(value)]++;
+    portEXIT_CRITICAL_SAFE(&s_hist_lock);
+}
+
+void lcd_stats_get(lcd_stats_metric_t metric, lcd_stats_hist_t *hist)
+{
+    if (metric >= LCD_STATS_METRIC_MAX) {
+        memset(hist, 0, sizeof(*hist));
+        return;
+    }
+
+    portENTER_CRITICAL(&s_hist_lock);
+    *hist = s_hist[metric];
+    portEXIT_CRITICAL(&s_hist_lock);
+}
+
+void lcd_stats_reset(void)
+{
+    portENTER_CRITICAL(&s_hist_lock);
+    memset(s_hist, 0, sizeof(s_hist));
+    portEXIT_CRITICAL(&s_hist_lock);
+}
+
+const char *lcd_stats_metric_name(lcd_stats_metric_t metric)
+{
+    return (metric < LCD_STATS_METRIC_MAX) ? s_metric_names[metric] : "?";
+}
+
+void lcd_stats_dump(void)
+{
+    for (int m = 0; m < LCD_STATS_METRIC_MAX; m++) {
+        lcd_stats_hist_t hist;
+        lcd_stats_get(m, &hist);
+
+        if (hist.count == 0) {
+            ESP_LOGI(TAG, "%-14s no samples", s_metric_names[m]);
+            continue;
+        }
+
+        ESP_LOGI(TAG, "%-14s n=%lu min=%lu avg=%lu max=%lu", s_metric_names[m],
+                 (unsigned long)hist.count, (unsigned long)hist.min,
+                 (unsigned long)(hist.sum / hist.count), (unsigned long)hist.max);
+
+        // One line per populated bucket: "<upper bound: count"
+        char line[96];
+        int len = 0;
+        for (int b = 0; b < LCD_STATS_HIST_BUCKETS; b++) {
+            if (hist.buckets[b] == 0) {
+                continue;
+            }
+            if (b == LCD_STATS_HIST_BUCKETS - 1) {
+                len += snprintf(line + len, sizeof(line) - len, " >=%lu:%lu",
+                                1UL << (b - 1), (unsigned long)hist.buckets[b]);
+            } else {
+                len += snprintf(line + len, sizeof(line) - len, " <%lu:%lu",
+                                1UL << b, (unsigned long)hist.buckets[b]);
+            }
+            if (len >= (int)sizeof(line) - 24) {
+                ESP_LOGI(TAG, "%-14s%s", "", line);
+                len = 0;
+            }
+        }
+        if (len > 0) {
+            ESP_LOGI(TAG, "%-14s%s", "", line);
+        }
+    }
+}
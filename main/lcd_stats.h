@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stdint.h>
+
+// Number of log2 buckets per histogram: bucket 0 holds zero, bucket i holds
+// values in [2^(i-1), 2^i), and the last bucket collects everything larger.
+#define LCD_STATS_HIST_BUCKETS  20
+
+typedef enum {
+    LCD_STATS_RENDER_US,      // LVGL drawing time per frame, flush waits excluded
+    LCD_STATS_FLUSH_WAIT_US,  // Time LVGL blocked waiting for the previous flush
+    LCD_STATS_DMA_US,         // draw_bitmap issued to colour transfer done
+    LCD_STATS_FLUSH_BYTES,    // Colour bytes sent per flush
+    LCD_STATS_FLUSH_AREA,     // Pixels per flush
+    LCD_STATS_OVERLAP_US,     // Rendering done while the previous flush was on the bus
+    LCD_STATS_FILL_AREA,      // Pixels per solid fill, sent without rendering (lcd_solid.h)
+    LCD_STATS_SKIP_BYTES,     // Colour bytes per flush not sent because the panel had them (lcd_hash.h)
+    LCD_STATS_METRIC_MAX,
+} lcd_stats_metric_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t buckets[LCD_STATS_HIST_BUCKETS];
+} lcd_stats_hist_t;
+
+// Add one sample to a histogram (safe to call from ISR context)
+void lcd_stats_record(lcd_stats_metric_t metric, uint32_t value);
+
+// Copy a histogram
+void lcd_stats_get(lcd_stats_metric_t metric, lcd_stats_hist_t *hist);
+
+// Clear all histograms
+void lcd_stats_reset(void);
+
+// Name of a metric, as used in the log dump
+const char *lcd_stats_metric_name(lcd_stats_metric_t metric);
+
+// Write all histograms to the log
+void lcd_stats_dump(void);
@@ -0,0 +1,111 @@
+#include <stdio.h>
+
+#include <esp_log.h>
+#include <lvgl.h>
+#include <src/themes/lv_theme_private.h>
+
+#include "lcd_theme.h"
+
+static const char *TAG = "lcd_theme";
+
+typedef struct {
+    lv_theme_t *base;     // lv_theme_default
+    lv_theme_t lean;      // base plus lcd_theme_lean_apply()
+    lv_style_t flat;
+    bool is_lean;
+} lcd_theme_ctx_t;
+
+static lcd_theme_ctx_t s_ctx;
+
+static bool lcd_theme_is_styled(lv_obj_t *obj)
+{
+    // Screens keep their plain background, lv_obj_create(parent) is a card
+    return lv_obj_check_type(obj, &lv_button_class) ||
+           (lv_obj_check_type(obj, &lv_obj_class) && lv_obj_get_parent(obj) != NULL);
+}
+
+// The default theme sets the grow transform and a transition for the
+// pressed state, which outweighs a style for the default state, so the flat
+// style is added for both
+static void lcd_theme_add_flat(lv_obj_t *obj)
+{
+    lv_obj_add_style(obj, &s_ctx.flat, LV_PART_MAIN);
+    lv_obj_add_style(obj, &s_ctx.flat, LV_PART_MAIN | LV_STATE_PRESSED);
+}
+
+// Runs after the default theme's apply callback and before the app adds its
+// own styles, so the flat style overrides the theme but not the app
+static void lcd_theme_lean_apply(lv_theme_t *theme, lv_obj_t *obj)
+{
+    LV_UNUSED(theme);
+
+    if (lcd_theme_is_styled(obj))
+    {
+        lcd_theme_add_flat(obj);
+    }
+}
+
+static lv_obj_tree_walk_res_t lcd_theme_restyle_cb(lv_obj_t *obj, void *user_data)
+{
+    if (lcd_theme_is_styled(obj))
+    {
+        lv_obj_remove_style(obj, &s_ctx.flat, LV_PART_ANY | LV_STATE_ANY);
+        if (s_ctx.is_lean)
+        {
+            lcd_theme_add_flat(obj);
+        }
+    }
+
+    return LV_OBJ_TREE_WALK_NEXT;
+}
+
+void lcd_theme_init(lv_display_t *disp, bool lean)
+{
+    s_ctx.base = lv_theme_default_init(disp, lv_palette_main(LV_PALETTE_BLUE),
+                                       lv_palette_main(LV_PALETTE_RED),
+                                       false,  //  dark theme
+                                       LV_FONT_DEFAULT);
+
+    // No radius, shadow, transform or transitions; only the properties the
+    // default theme spends render time on, so the colours stay its own
+    lv_style_init(&s_ctx.flat);
+    lv_style_set_radius(&s_ctx.flat, 0);
+    lv_style_set_shadow_width(&s_ctx.flat, 0);
+    lv_style_set_shadow_opa(&s_ctx.flat, LV_OPA_TRANSP);
+    lv_style_set_transform_width(&s_ctx.flat, 0);
+    lv_style_set_transform_height(&s_ctx.flat, 0);
+    lv_style_set_transition(&s_ctx.flat, NULL);
+
+    s_ctx.lean = *s_ctx.base;
+    lv_theme_set_parent(&s_ctx.lean, s_ctx.base);
+    lv_theme_set_apply_cb(&s_ctx.lean, lcd_theme_lean_apply);
+
+    s_ctx.is_lean = lean;
+    lv_display_set_theme(disp, lean ? &s_ctx.lean : s_ctx.base);
+
+    ESP_LOGI(TAG, "%s theme", lean ? "Lean" : "Default");
+}
+
+void lcd_theme_set_lean(lv_display_t *disp, bool lean)
+{
+    if (lean == s_ctx.is_lean)
+    {
+        return;
+    }
+
+    s_ctx.is_lean = lean;
+    lv_display_set_theme(disp, lean ? &s_ctx.lean : s_ctx.base);
+
+    // Added back after the app's styles, which is fine while the app sets
+    // none of the flat style's properties
+    lv_obj_tree_walk(lv_display_get_screen_active(disp), lcd_theme_restyle_cb, NULL);
+    lv_obj_tree_walk(lv_display_get_layer_top(disp), lcd_theme_restyle_cb, NULL);
+    lv_obj_tree_walk(lv_display_get_layer_sys(disp), lcd_theme_restyle_cb, NULL);
+
+    ESP_LOGI(TAG, "Switched to the %s theme", lean ? "lean" : "default");
+}
+
+bool lcd_theme_is_lean(void)
+{
+    return s_ctx.is_lean;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdbool.h>
+
+#include <lvgl.h>
+
+// Lean theme (LCD_THEME_LEAN). lv_theme_default gives buttons rounded
+// corners, a drop shadow, a grow-on-press transform and style transitions,
+// all rendered in software: the corners and the shadow on every redraw of
+// the button, the grow and the transitions as extra animated frames on every
+// press. The lean theme is the default theme with a layer on top that takes
+// those out of buttons and plain containers. Colours, fonts, padding and the
+// layout stay the same, fills are flat rectangles and state changes are
+// drawn in one frame.
+
+// Install the default theme on disp, with the lean layer on top if lean
+void lcd_theme_init(lv_display_t *disp, bool lean);
+
+// Switch the lean layer on or off at runtime. Objects on the active screen
+// and the top and system layers are restyled; other screens keep their look
+// until they are recreated.
+void lcd_theme_set_lean(lv_display_t *disp, bool lean);
+
+bool lcd_theme_is_lean(void);
@@ -0,0 +1,331 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+
+#include <esp_log.h>
+#include <esp_heap_caps.h>
+#include <multi_heap.h>
+#include <lvgl.h>
+
+#include "hardware.h"
+#include "lvgl_mem.h"
+
+#if LV_USE_STDLIB_MALLOC == LV_STDLIB_CUSTOM
+
+static const char *TAG = "lvgl_mem";
+
+#define LVGL_MEM_CAPS  (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
+
+static const char *const s_category_names[LVGL_MEM_CATEGORY_MAX] = {
+    [LVGL_MEM_OBJECTS] = "objects",
+    [LVGL_MEM_SCRATCH] = "scratch",
+};
+
+static lvgl_mem_info_t s_info[LVGL_MEM_CATEGORY_MAX];
+static portMUX_TYPE s_info_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static uint8_t *s_arena;
+static multi_heap_handle_t s_scratch;
+static portMUX_TYPE s_scratch_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Set between LV_EVENT_RENDER_START and LV_EVENT_RENDER_READY; the draw unit
+// tasks only allocate inside that window
+static volatile bool s_rendering;
+
+static bool lvgl_mem_in_arena(const void *p)
+{
+    return s_arena != NULL && (const uint8_t *)p >= s_arena && (const uint8_t *)p < s_arena + LVGL_MEM_SCRATCH_SIZE;
+}
+
+static size_t lvgl_mem_block_size(void *p)
+{
+    return lvgl_mem_in_arena(p) ? multi_heap_get_allocated_size(s_scratch, p) : heap_caps_get_allocated_size(p);
+}
+
+// Blocks are charged to the region they live in: scratch overflowing into
+// the heap counts as objects, and as an overflow of scratch
+static lvgl_mem_category_t lvgl_mem_category_of(const void *p)
+{
+    return lvgl_mem_in_arena(p) ? LVGL_MEM_SCRATCH : LVGL_MEM_OBJECTS;
+}
+
+// Account a block of freed bytes going and one of allocated bytes coming,
+// either may be 0; both are non-zero for a realloc in place
+static void lvgl_mem_count(lvgl_mem_category_t category, size_t freed, size_t allocated)
+{
+    lvgl_mem_info_t *info = &s_info[category];
+
+    portENTER_CRITICAL(&s_info_lock);
+    info->used -= LV_MIN(freed, info->used);
+    info->used += allocated;
+    if (freed == 0 && allocated != 0)
+    {
+        info->live++;
+        info->allocs++;
+    }
+    else if (freed != 0 && allocated == 0 && info->live > 0)
+    {
+        info->live--;
+    }
+    if (info->used > info->peak)
+    {
+        info->peak = info->used;
+    }
+    portEXIT_CRITICAL(&s_info_lock);
+}
+
+static void lvgl_mem_count_failed(lvgl_mem_category_t category, bool overflow)
+{
+    portENTER_CRITICAL(&s_info_lock);
+    s_info[category].failed += !overflow;
+    s_info[LVGL_MEM_SCRATCH].overflows += overflow;
+    portEXIT_CRITICAL(&s_info_lock);
+}
+
+static void lvgl_mem_render_event_cb(lv_event_t *e)
+{
+    if (lv_event_get_code(e) == LV_EVENT_RENDER_START)
+    {
+        s_rendering = true;
+        return;
+    }
+
+    s_rendering = false;
+
+    // Scratch still in use after the frame is really long-lived, e.g. caches
+    portENTER_CRITICAL(&s_info_lock);
+    if (s_info[LVGL_MEM_SCRATCH].used > s_info[LVGL_MEM_SCRATCH].retained)
+    {
+        s_info[LVGL_MEM_SCRATCH].retained = s_info[LVGL_MEM_SCRATCH].used;
+    }
+    portEXIT_CRITICAL(&s_info_lock);
+}
+
+void lv_mem_init(void)
+{
+    s_arena = heap_caps_malloc(LVGL_MEM_SCRATCH_SIZE, LVGL_MEM_CAPS);
+    s_scratch = (s_arena != NULL) ? multi_heap_register(s_arena, LVGL_MEM_SCRATCH_SIZE) : NULL;
+    if (s_scratch == NULL)
+    {
+        ESP_LOGW(TAG, "No %u-byte scratch arena, draw scratch comes from the heap", (unsigned)LVGL_MEM_SCRATCH_SIZE);
+        heap_caps_free(s_arena);
+        s_arena = NULL;
+        return;
+    }
+
+    // Draw unit tasks allocate concurrently with the LVGL task
+    multi_heap_set_lock(s_scratch, &s_scratch_lock);
+    s_info[LVGL_MEM_SCRATCH].region_size = LVGL_MEM_SCRATCH_SIZE;
+
+    ESP_LOGI(TAG, "LVGL memory from heap_caps, %u-byte scratch arena", (unsigned)LVGL_MEM_SCRATCH_SIZE);
+}
+
+void lv_mem_deinit(void)
+{
+    // lv_deinit() has freed everything by now
+    s_scratch = NULL;
+    heap_caps_free(s_arena);
+    s_arena = NULL;
+}
+
+lv_mem_pool_t lv_mem_add_pool(void *mem, size_t bytes)
+{
+    LV_UNUSED(mem);
+    LV_UNUSED(bytes);
+
+    return NULL;
+}
+
+void lv_mem_remove_pool(lv_mem_pool_t pool)
+{
+    LV_UNUSED(pool);
+}
+
+void *lv_malloc_core(size_t size)
+{
+    void *p = NULL;
+
+    if (s_rendering && s_scratch != NULL)
+    {
+        p = multi_heap_malloc(s_scratch, size);
+        if (p == NULL)
+        {
+            lvgl_mem_count_failed(LVGL_MEM_SCRATCH, true);
+        }
+    }
+    if (p == NULL)
+    {
+        p = heap_caps_malloc(size, LVGL_MEM_CAPS);
+    }
+
+    if (p == NULL)
+    {
+        lvgl_mem_count_failed(s_rendering ? LVGL_MEM_SCRATCH : LVGL_MEM_OBJECTS, false);
+        return NULL;
+    }
+
+    lvgl_mem_count(lvgl_mem_category_of(p), 0, lvgl_mem_block_size(p));
+    return p;
+}
+
+void lv_free_core(void *p)
+{
+    if (p == NULL)
+    {
+        return;
+    }
+
+    lvgl_mem_count(lvgl_mem_category_of(p), lvgl_mem_block_size(p), 0);
+    if (lvgl_mem_in_arena(p))
+    {
+        multi_heap_free(s_scratch, p);
+    }
+    else
+    {
+        heap_caps_free(p);
+    }
+}
+
+void *lv_realloc_core(void *p, size_t new_size)
+{
+    if (p == NULL)
+    {
+        return lv_malloc_core(new_size);
+    }
+
+    // Resized in the region the block lives in
+    const lvgl_mem_category_t category = lvgl_mem_category_of(p);
+    const size_t old_size = lvgl_mem_block_size(p);
+    void *q = (category == LVGL_MEM_SCRATCH) ? multi_heap_realloc(s_scratch, p, new_size)
+                                             : heap_caps_realloc(p, new_size, LVGL_MEM_CAPS);
+    if (q != NULL)
+    {
+        lvgl_mem_count(category, old_size, lvgl_mem_block_size(q));
+        return q;
+    }
+    if (category == LVGL_MEM_OBJECTS)
+    {
+        lvgl_mem_count_failed(LVGL_MEM_OBJECTS, false);
+        return NULL;
+    }
+
+    // Arena full: move the block to the heap
+    lvgl_mem_count_failed(LVGL_MEM_SCRATCH, true);
+    q = heap_caps_malloc(new_size, LVGL_MEM_CAPS);
+    if (q == NULL)
+    {
+        lvgl_mem_count_failed(LVGL_MEM_SCRATCH, false);
+        return NULL;
+    }
+    lvgl_mem_count(LVGL_MEM_OBJECTS, 0, lvgl_mem_block_size(q));
+    memcpy(q, p, LV_MIN(old_size, new_size));
+    lv_free_core(p);
+
+    return q;
+}
+
+lv_result_t lv_mem_test_core(void)
+{
+    if (s_scratch != NULL && !multi_heap_check(s_scratch, false))
+    {
+        return LV_RESULT_INVALID;
+    }
+
+    return heap_caps_check_integrity(LVGL_MEM_CAPS, false) ? LV_RESULT_OK : LV_RESULT_INVALID;
+}
+
+// Feeds lv_mem_monitor() and the sysmon memory overlay: both categories
+// together, against the scratch arena plus the free internal heap
+void lv_mem_monitor_core(lv_mem_monitor_t *mon_p)
+{
+    lvgl_mem_info_t objects;
+    lvgl_mem_info_t scratch;
+
+    lvgl_mem_get_info(LVGL_MEM_OBJECTS, &objects);
+    lvgl_mem_get_info(LVGL_MEM_SCRATCH, &scratch);
+
+    mon_p->used_cnt = objects.live + scratch.live;
+    mon_p->max_used = objects.peak + scratch.peak;
+    mon_p->free_size = objects.free_bytes + scratch.free_bytes;
+    mon_p->free_biggest_size = LV_MAX(objects.largest_free, scratch.largest_free);
+    mon_p->free_cnt = 0;
+    mon_p->total_size = objects.used + scratch.used + mon_p->free_size;
+    mon_p->used_pct = mon_p->total_size ? (uint8_t)(100 - (uint64_t)mon_p->free_size * 100 / mon_p->total_size) : 0;
+    mon_p->frag_pct = mon_p->free_size ? (uint8_t)(100 - (uint64_t)mon_p->free_biggest_size * 100 / mon_p->free_size) : 0;
+}
+
+void lvgl_mem_watch_display(lv_display_t *disp)
+{
+    lv_display_add_event_cb(disp, lvgl_mem_render_event_cb, LV_EVENT_RENDER_START, NULL);
+    lv_display_add_event_cb(disp, lvgl_mem_render_event_cb, LV_EVENT_RENDER_READY, NULL);
+}
+
+void lvgl_mem_get_info(lvgl_mem_category_t category, lvgl_mem_info_t *info)
+{
+    portENTER_CRITICAL(&s_info_lock);
+    *info = s_info[category];
+    portEXIT_CRITICAL(&s_info_lock);
+
+    if (category == LVGL_MEM_SCRATCH && s_scratch != NULL)
+    {
+        multi_heap_info_t heap;
+        multi_heap_get_info(s_scratch, &heap);
+        info->free_bytes = heap.total_free_bytes;
+        info->largest_free = heap.largest_free_block;
+    }
+    else if (category == LVGL_MEM_OBJECTS)
+    {
+        info->free_bytes = heap_caps_get_free_size(LVGL_MEM_CAPS);
+        info->largest_free = heap_caps_get_largest_free_block(LVGL_MEM_CAPS);
+    }
+    info->frag_pct = info->free_bytes ? (uint8_t)(100 - (uint64_t)info->largest_free * 100 / info->free_bytes) : 0;
+}
+
+const char *lvgl_mem_category_name(lvgl_mem_category_t category)
+{
+    return (category < LVGL_MEM_CATEGORY_MAX) ? s_category_names[category] : "?";
+}
+
+int lvgl_mem_to_json(char *buf, size_t size)
+{
+    int len = snprintf(buf, size, "{");
+
+    for (int c = 0; c < LVGL_MEM_CATEGORY_MAX; c++)
+    {
+        lvgl_mem_info_t info;
+        lvgl_mem_get_info(c, &info);
+
+        len += snprintf(buf + LV_MIN((size_t)len, size), size - LV_MIN((size_t)len, size),
+                        "%s\"%s\":{\"used\":%lu,\"peak\":%lu,\"live\":%lu,\"allocs\":%lu,\"failed\":%lu,"
+                        "\"overflows\":%lu,\"retained\":%lu,\"region\":%lu,\"free\":%lu,\"largest_free\":%lu,\"frag_pct\":%u}",
+                        c ? "," : "", s_category_names[c], (unsigned long)info.used, (unsigned long)info.peak,
+                        (unsigned long)info.live, (unsigned long)info.allocs, (unsigned long)info.failed,
+                        (unsigned long)info.overflows, (unsigned long)info.retained, (unsigned long)info.region_size,
+                        (unsigned long)info.free_bytes, (unsigned long)info.largest_free, (unsigned)info.frag_pct);
+    }
+    len += snprintf(buf + LV_MIN((size_t)len, size), size - LV_MIN((size_t)len, size), "}");
+
+    return len;
+}
+
+void lvgl_mem_dump(void)
+{
+    for (int c = 0; c < LVGL_MEM_CATEGORY_MAX; c++)
+    {
+        lvgl_mem_info_t info;
+        lvgl_mem_get_info(c, &info);
+
+        ESP_LOGI(TAG, "%-8s used=%lu peak=%lu live=%lu allocs=%lu failed=%lu free=%lu largest=%lu frag=%u%%",
+                 s_category_names[c], (unsigned long)info.used, (unsigned long)info.peak,
+                 (unsigned long)info.live, (unsigned long)info.allocs, (unsigned long)info.failed,
+                 (unsigned long)info.free_bytes, (unsigned long)info.largest_free, (unsigned)info.frag_pct);
+    }
+
+    lvgl_mem_info_t scratch;
+    lvgl_mem_get_info(LVGL_MEM_SCRATCH, &scratch);
+    ESP_LOGI(TAG, "scratch  arena=%lu overflows=%lu retained=%lu", (unsigned long)scratch.region_size,
+             (unsigned long)scratch.overflows, (unsigned long)scratch.retained);
+}
+
+#endif
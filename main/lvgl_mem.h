@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <lvgl.h>
+
+// LVGL allocator on heap_caps (CONFIG_LV_USE_CUSTOM_MALLOC), replacing the
+// fixed CONFIG_LV_MEM_SIZE_KILOBYTES pool. Allocations fall in two categories:
+//
+//  - objects: everything made outside rendering (widgets, styles, timers,
+//    label text). Served from the internal heap, so it takes what the UI
+//    actually needs.
+//  - scratch: everything made while a watched display renders a frame,
+//    mostly draw tasks and layers that are gone by the end of it. Served
+//    from a LVGL_MEM_SCRATCH_SIZE arena of its own, so that churn does not
+//    fragment the heap around long-lived objects, and from the heap when
+//    the arena is full.
+//
+// Each category keeps its usage, peak, counts and fragmentation since boot,
+// so both sizes can be set from real data.
+
+typedef enum {
+    LVGL_MEM_OBJECTS,
+    LVGL_MEM_SCRATCH,
+    LVGL_MEM_CATEGORY_MAX,
+} lvgl_mem_category_t;
+
+typedef struct {
+    uint32_t used;          // Bytes in use now, allocator overhead included
+    uint32_t peak;          // Highest used since boot
+    uint32_t live;          // Blocks in use now
+    uint32_t allocs;        // Blocks allocated since boot, reallocs that moved them included
+    uint32_t failed;        // Allocations that returned NULL
+    uint32_t overflows;     // Scratch only: went to the heap, and count as objects, because the arena was full
+    uint32_t retained;      // Scratch only: highest used at the end of a frame, i.e. kept past it
+    uint32_t region_size;   // Scratch arena size; 0 for objects, which share the internal heap
+    uint32_t free_bytes;    // Free in the category's region
+    uint32_t largest_free;  // Largest free block in the region
+    uint8_t frag_pct;       // 100 - largest_free / free_bytes, in percent
+} lvgl_mem_info_t;
+
+// Count allocations made while disp renders as scratch
+void lvgl_mem_watch_display(lv_display_t *disp);
+
+void lvgl_mem_get_info(lvgl_mem_category_t category, lvgl_mem_info_t *info);
+
+// Name of a category, as used in the log and JSON
+const char *lvgl_mem_category_name(lvgl_mem_category_t category);
+
+// Write both categories as one JSON object, e.g. for publishing. Returns the
+// length snprintf() would have written.
+int lvgl_mem_to_json(char *buf, size_t size);
+
+// Write the stats to the log
+void lvgl_mem_dump(void);
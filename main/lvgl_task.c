@@ -0,0 +1,178 @@
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+
+#include <esp_log.h>
+#include <esp_err.h>
+#include <esp_check.h>
+#include <esp_sleep.h>
+#include <esp_timer.h>
+#include <esp_lcd_touch.h>
+#include <driver/gpio.h>
+#include <lvgl.h>
+
+#include "lvgl_task.h"
+
+static const char *TAG = "lvgl_task";
+
+static SemaphoreHandle_t s_lock;   // Recursive, same semantics as lvgl_port_lock()
+static SemaphoreHandle_t s_wake;   // Binary, given by anything that needs lv_timer_handler()
+static TaskHandle_t s_task;
+static lv_indev_t *s_touch_indev;
+static volatile bool s_touch_irq;  // Set by the touch IRQ, read by the LVGL task
+
+static uint32_t lvgl_task_tick_get(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+static void lvgl_task_main(void *arg)
+{
+    ESP_LOGI(TAG, "Started on core %d", xPortGetCoreID());
+
+    for (;;)
+    {
+        uint32_t delay_ms = LV_NO_TIMER_READY;
+
+        if (xSemaphoreTakeRecursive(s_lock, portMAX_DELAY) == pdTRUE)
+        {
+            if (s_touch_irq && s_touch_indev != NULL)
+            {
+                s_touch_irq = false;
+                lv_indev_read(s_touch_indev);
+            }
+            delay_ms = lv_timer_handler();
+
+            // Not lvgl_task_unlock(): it would wake this task again
+            xSemaphoreGiveRecursive(s_lock);
+        }
+
+        // Nothing pending means nothing to do until another task or an IRQ wakes us
+        TickType_t wait = portMAX_DELAY;
+        if (delay_ms != LV_NO_TIMER_READY)
+        {
+            wait = (delay_ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS;
+        }
+        xSemaphoreTake(s_wake, wait);
+    }
+}
+
+esp_err_t lvgl_task_init(int priority, int stack, int affinity)
+{
+    ESP_RETURN_ON_FALSE(s_task == NULL, ESP_ERR_INVALID_STATE, TAG, "Already initialized");
+
+    lv_init();
+    lv_tick_set_cb(lvgl_task_tick_get);
+
+    s_lock = xSemaphoreCreateRecursiveMutex();
+    s_wake = xSemaphoreCreateBinary();
+    ESP_RETURN_ON_FALSE(s_lock != NULL && s_wake != NULL, ESP_ERR_NO_MEM, TAG, "No memory for LVGL task semaphores");
+
+    BaseType_t res = xTaskCreatePinnedToCore(lvgl_task_main, "LVGL task", stack, NULL, priority, &s_task,
+                                             affinity < 0 ? tskNO_AFFINITY : affinity);
+    ESP_RETURN_ON_FALSE(res == pdPASS, ESP_FAIL, TAG, "Failed to create LVGL task");
+
+    return ESP_OK;
+}
+
+bool lvgl_task_lock(uint32_t timeout_ms)
+{
+    const TickType_t ticks = (timeout_ms == 0) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+
+    return xSemaphoreTakeRecursive(s_lock, ticks) == pdTRUE;
+}
+
+void lvgl_task_unlock(void)
+{
+    xSemaphoreGiveRecursive(s_lock);
+
+    if (xTaskGetCurrentTaskHandle() != s_task)
+    {
+        lvgl_task_wake();
+    }
+}
+
+void lvgl_task_wake(void)
+{
+    xSemaphoreGive(s_wake);
+}
+
+// Touch IRQ (GPIO ISR). The interrupt stays off until the touch is released,
+// the LVGL task polls the controller in between.
+static void lvgl_task_touch_isr(esp_lcd_touch_handle_t tp)
+{
+    BaseType_t need_yield = pdFALSE;
+
+    gpio_intr_disable(tp->config.int_gpio_num);
+    s_touch_irq = true;
+    xSemaphoreGiveFromISR(s_wake, &need_yield);
+
+    if (need_yield == pdTRUE)
+    {
+        portYIELD_FROM_ISR();
+    }
+}
+
+static void lvgl_task_touch_read(lv_indev_t *indev, lv_indev_data_t *data)
+{
+    esp_lcd_touch_handle_t tp = lv_indev_get_driver_data(indev);
+    uint16_t x, y;
+    uint8_t count = 0;
+
+    esp_lcd_touch_read_data(tp);
+    bool pressed = esp_lcd_touch_get_coordinates(tp, &x, &y, NULL, &count, 1) && count > 0;
+
+    if (pressed)
+    {
+        data->point.x = x;
+        data->point.y = y;
+        data->state = LV_INDEV_STATE_PRESSED;
+    }
+    else
+    {
+        data->state = LV_INDEV_STATE_RELEASED;
+    }
+
+    // Poll at LV_DEF_REFR_PERIOD only while a finger is down
+    if (tp->config.int_gpio_num != GPIO_NUM_NC)
+    {
+        lv_indev_set_mode(indev, pressed ? LV_INDEV_MODE_TIMER : LV_INDEV_MODE_EVENT);
+        if (!pressed)
+        {
+            gpio_intr_enable(tp->config.int_gpio_num);
+        }
+    }
+}
+
+lv_indev_t *lvgl_task_add_touch(lv_display_t *disp, esp_lcd_touch_handle_t tp)
+{
+    lv_indev_t *indev = lv_indev_create();
+    if (indev == NULL)
+    {
+        return NULL;
+    }
+
+    lv_indev_set_type(indev, LV_INDEV_TYPE_POINTER);
+    lv_indev_set_display(indev, disp);
+    lv_indev_set_driver_data(indev, tp);
+    lv_indev_set_read_cb(indev, lvgl_task_touch_read);
+
+    const gpio_num_t irq = tp->config.int_gpio_num;
+    if (irq != GPIO_NUM_NC && esp_lcd_touch_register_interrupt_callback(tp, lvgl_task_touch_isr) == ESP_OK)
+    {
+        s_touch_indev = indev;
+        lv_indev_set_mode(indev, LV_INDEV_MODE_EVENT);
+#if CONFIG_PM_ENABLE
+        // Edge interrupts do not wake the chip from light sleep, a low level does
+        gpio_wakeup_enable(irq, GPIO_INTR_LOW_LEVEL);
+        esp_sleep_enable_gpio_wakeup();
+#endif
+        ESP_LOGI(TAG, "Touch on IRQ GPIO %d, read on interrupt", irq);
+    }
+    else
+    {
+        ESP_LOGI(TAG, "Touch has no IRQ, polled every %d ms", LV_DEF_REFR_PERIOD);
+    }
+
+    return indev;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <esp_err.h>
+#include <esp_lcd_touch.h>
+#include <lvgl.h>
+
+// Event-driven replacement for the esp_lvgl_port task (LVGL_EVENT_DRIVEN).
+// The task runs lv_timer_handler() and then blocks until the next lv_timer is
+// due, another task releases the LVGL lock, or the touch IRQ fires. There is
+// no tick timer: lv_tick reads esp_timer directly.
+
+// Initialize LVGL and start the task. Call once, before any other LVGL call
+esp_err_t lvgl_task_init(int priority, int stack, int affinity);
+
+// Take the LVGL lock (recursive), 0 = wait forever
+bool lvgl_task_lock(uint32_t timeout_ms);
+
+// Release the LVGL lock. Releasing it from any task but the LVGL task wakes
+// the LVGL task, since the caller may have invalidated objects or changed timers
+void lvgl_task_unlock(void);
+
+// Run lv_timer_handler() as soon as possible
+void lvgl_task_wake(void);
+
+// Register the touch controller as LVGL pointer input. With an IRQ line the
+// input device is only read after an interrupt and while pressed, otherwise
+// it is polled every LV_DEF_REFR_PERIOD. Call with the LVGL lock held.
+lv_indev_t *lvgl_task_add_touch(lv_display_t *disp, esp_lcd_touch_handle_t tp);
@@ -279,9 +279,8 @@ static void handle_valve_command(const char* payload, int payload_len) {
         return;
     }
     
-    // Set valve state and publish confirmation
+    // The UI publishes the confirmation, also when the valve is already in that state
     ESP_LOGI(TAG, "Setting water valve to %s via MQTT", state ? "ON" : "OFF");
-    mqtt_publish_relay_state(1, state);
     
     // Notify UI about state change if callback is registered
     if (state_change_callback != NULL) {
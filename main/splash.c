@@ -0,0 +1,108 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <esp_check.h>
+#include <esp_heap_caps.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_lcd_panel_ops.h>
+#include <lvgl.h>
+
+#include "hardware.h"
+#include "img_rle565.h"
+#include "lcd_pixel.h"
+#include "splash.h"
+
+static const char *TAG = "splash";
+
+#define SPLASH_BAND_LINES  16
+
+static inline uint16_t splash_blend(uint16_t fg, uint16_t bg, uint32_t a)
+{
+    const uint32_t r = ((fg >> 11) * a + (bg >> 11) * (255 - a) + 127) / 255;
+    const uint32_t g = (((fg >> 5) & 0x3F) * a + ((bg >> 5) & 0x3F) * (255 - a) + 127) / 255;
+    const uint32_t b = ((fg & 0x1F) * a + (bg & 0x1F) * (255 - a) + 127) / 255;
+
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+// Compose screen rows [y, y + lines) into band: background, then the image
+// rows that fall into the band
+static void splash_band(const img_rle565_t *img, int32_t x0, int32_t y0, int32_t y, int32_t lines,
+                        uint16_t bg, uint16_t *band, uint16_t *color, uint8_t *alpha)
+{
+    for (int32_t i = 0; i < LCD_H_RES * lines; i++)
+    {
+        band[i] = bg;
+    }
+
+    const int32_t first = LV_MAX(y, y0);
+    const int32_t last = LV_MIN(y + lines, y0 + img->h);
+    if (first >= last)
+    {
+        return;
+    }
+
+    img_rle565_decode_rows(img, first - y0, last - first, color, img->w * sizeof(uint16_t), alpha, img->w);
+
+    for (int32_t row = 0; row < last - first; row++)
+    {
+        uint16_t *dst = band + (first - y + row) * LCD_H_RES + x0;
+        const uint16_t *src = color + row * img->w;
+        const uint8_t *a = alpha + row * img->w;
+
+        for (int32_t x = 0; x < img->w; x++)
+        {
+            dst[x] = img->alpha ? splash_blend(src[x], bg, a[x]) : src[x];
+        }
+    }
+}
+
+esp_err_t splash_show(esp_lcd_panel_handle_t panel, const lv_image_dsc_t *img_dsc, lv_color_t bg_color)
+{
+    const int64_t start = esp_timer_get_time();
+    img_rle565_t img;
+
+    ESP_RETURN_ON_FALSE(img_rle565_parse(&img, img_dsc->data, img_dsc->data_size) &&
+                        img.w <= LCD_H_RES && img.h <= LCD_V_RES,
+                        ESP_ERR_INVALID_ARG, TAG, "Splash is not a screen-sized img_rle565 image");
+
+    // Two bands, so one is composed while the other is on the bus
+    const size_t band_size = LCD_H_RES * SPLASH_BAND_LINES * sizeof(uint16_t);
+    uint16_t *band[2] = {
+        heap_caps_malloc(band_size, MALLOC_CAP_DMA),
+        heap_caps_malloc(band_size, MALLOC_CAP_DMA),
+    };
+    uint16_t *color = malloc(img.w * SPLASH_BAND_LINES * (sizeof(uint16_t) + 1));
+    esp_err_t ret = ESP_OK;
+
+    ESP_GOTO_ON_FALSE(band[0] != NULL && band[1] != NULL && color != NULL, ESP_ERR_NO_MEM, out, TAG,
+                      "No memory for splash bands");
+
+    const uint16_t bg = lv_color_to_u16(bg_color);
+    const int32_t x0 = (LCD_H_RES - img.w) / 2;
+    const int32_t y0 = (LCD_V_RES - img.h) / 2;
+    uint8_t *alpha = (uint8_t *)(color + img.w * SPLASH_BAND_LINES);
+
+    for (int32_t y = 0, i = 0; y < LCD_V_RES; y += SPLASH_BAND_LINES, i ^= 1)
+    {
+        const int32_t lines = LV_MIN(SPLASH_BAND_LINES, LCD_V_RES - y);
+
+        // Issuing band N - 1 waited for band N - 2, the last user of this buffer
+        splash_band(&img, x0, y0, y, lines, bg, band[i], color, alpha);
+        lcd_pixel_swap_rgb565(band[i], LCD_H_RES * lines);
+        ESP_GOTO_ON_ERROR(esp_lcd_panel_draw_bitmap(panel, 0, y, LCD_H_RES, y + lines, band[i]), out, TAG,
+                          "Splash band at row %d failed", (int)y);
+    }
+
+    ESP_LOGI(TAG, "Splash %dx%d drawn in %lld us", (int)img.w, (int)img.h, (long long)(esp_timer_get_time() - start));
+
+out:
+    // Panel commands wait for queued colour transfers, so the bands can be freed after this
+    esp_lcd_panel_disp_on_off(panel, true);
+    free(color);
+    heap_caps_free(band[1]);
+    heap_caps_free(band[0]);
+
+    return ret;
+}
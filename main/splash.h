@@ -0,0 +1,15 @@
+#pragma once
+
+#include <esp_err.h>
+#include <esp_lcd_panel_ops.h>
+#include <lvgl.h>
+
+// Boot splash drawn straight to the panel with esp_lcd_panel_draw_bitmap(),
+// so the screen can light up right after app_lcd_init() instead of after
+// LVGL, touch and WiFi are up. LVGL is not needed: img must be an image from
+// main/images (see img_rle565.h), which is decoded and blended over bg_color
+// one band at a time. The first LVGL frame replaces it.
+
+// Fill the screen with bg_color and img centred. Returns once every band has
+// been sent, ESP_ERR_NO_MEM if no DMA-capable band buffers are available.
+esp_err_t splash_show(esp_lcd_panel_handle_t panel, const lv_image_dsc_t *img, lv_color_t bg_color);
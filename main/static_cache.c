@@ -0,0 +1,341 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <esp_log.h>
+#include <lvgl.h>
+#include <src/core/lv_obj_private.h>
+
+#include "hardware.h"
+#include "static_cache.h"
+
+static const char *TAG = "static_cache";
+
+#define STATIC_CACHE_MAX_ENTRIES   8
+#define STATIC_CACHE_MAX_CHILDREN  32   // Direct children tracked in hidden_mask
+
+typedef struct {
+    lv_obj_t *root;
+    lv_draw_buf_t buf;       // Snapshot of root and its children, over black
+    uint8_t *data;
+    uint32_t size;
+    bool valid;              // buf matches what live rendering would produce
+    bool blitting;           // The current draw of root comes from buf
+    uint32_t hidden_mask;    // Children hidden by us for the current draw
+    lv_timer_t *settle;      // One-shot re-snapshot after the subtree stops changing
+} static_cache_entry_t;
+
+static static_cache_entry_t s_entries[STATIC_CACHE_MAX_ENTRIES];
+static static_cache_stats_t s_stats;
+static bool s_snapshotting;
+
+static const lv_event_code_t s_change_events[] = {
+    LV_EVENT_STYLE_CHANGED,
+    LV_EVENT_STATE_CHANGED,
+    LV_EVENT_SIZE_CHANGED,
+    LV_EVENT_VALUE_CHANGED,
+    LV_EVENT_CHILD_CHANGED,
+    LV_EVENT_CHILD_CREATED,
+    LV_EVENT_CHILD_DELETED,
+};
+
+static const lv_event_code_t s_draw_events[] = {
+    LV_EVENT_DRAW_MAIN_BEGIN,
+    LV_EVENT_DRAW_MAIN,
+    LV_EVENT_DRAW_MAIN_END,
+    LV_EVENT_DRAW_POST_BEGIN,
+    LV_EVENT_DRAW_POST,
+    LV_EVENT_DRAW_POST_END,
+};
+
+static static_cache_entry_t *static_cache_find(lv_obj_t *obj)
+{
+    for (; obj != NULL; obj = lv_obj_get_parent(obj))
+    {
+        for (int i = 0; i < STATIC_CACHE_MAX_ENTRIES; i++)
+        {
+            if (s_entries[i].root == obj)
+            {
+                return &s_entries[i];
+            }
+        }
+    }
+
+    return NULL;
+}
+
+static bool static_cache_snapshot(static_cache_entry_t *ent)
+{
+    // Our draw handlers must not blit the buffer that is being rendered into
+    ent->valid = false;
+    s_snapshotting = true;
+    lv_obj_update_layout(ent->root);
+    lv_result_t res = lv_snapshot_take_to_draw_buf(ent->root, LV_COLOR_FORMAT_RGB565, &ent->buf);
+    s_snapshotting = false;
+
+    if (res != LV_RESULT_OK)
+    {
+        ESP_LOGD(TAG, "Snapshot of %p failed, rendering live", (void *)ent->root);
+        return false;
+    }
+
+    lv_image_cache_drop(&ent->buf);
+    ent->valid = true;
+    s_stats.snapshots++;
+
+    return true;
+}
+
+static void static_cache_settle_cb(lv_timer_t *timer)
+{
+    static_cache_entry_t *ent = lv_timer_get_user_data(timer);
+
+    // Repeat count 1: LVGL deletes the timer after this callback
+    ent->settle = NULL;
+    static_cache_snapshot(ent);
+}
+
+static void static_cache_mark_stale(static_cache_entry_t *ent)
+{
+    if (s_snapshotting)
+    {
+        return;
+    }
+
+    ent->valid = false;
+
+    if (ent->settle == NULL)
+    {
+        ent->settle = lv_timer_create(static_cache_settle_cb, LCD_STATIC_CACHE_SETTLE_MS, ent);
+        lv_timer_set_repeat_count(ent->settle, 1);
+    }
+    else
+    {
+        lv_timer_reset(ent->settle);
+    }
+}
+
+static void static_cache_watch(lv_obj_t *obj, static_cache_entry_t *ent);
+
+static void static_cache_change_cb(lv_event_t *e)
+{
+    static_cache_entry_t *ent = lv_event_get_user_data(e);
+
+    if (lv_event_get_code(e) == LV_EVENT_CHILD_CREATED)
+    {
+        lv_obj_t *child = lv_event_get_param(e);
+        if (child != NULL)
+        {
+            static_cache_watch(child, ent);
+        }
+    }
+
+    static_cache_mark_stale(ent);
+}
+
+static lv_obj_tree_walk_res_t static_cache_watch_walk_cb(lv_obj_t *obj, void *user_data)
+{
+    for (size_t i = 0; i < sizeof(s_change_events) / sizeof(s_change_events[0]); i++)
+    {
+        lv_obj_add_event_cb(obj, static_cache_change_cb, s_change_events[i], user_data);
+    }
+
+    return LV_OBJ_TREE_WALK_NEXT;
+}
+
+static void static_cache_watch(lv_obj_t *obj, static_cache_entry_t *ent)
+{
+    lv_obj_tree_walk(obj, static_cache_watch_walk_cb, ent);
+}
+
+static void static_cache_children_hide(static_cache_entry_t *ent)
+{
+    const uint32_t count = lv_obj_get_child_count(ent->root);
+
+    // Raw flag bits: lv_obj_add_flag() would invalidate and relayout mid-render
+    ent->hidden_mask = 0;
+    for (uint32_t i = 0; i < count && i < STATIC_CACHE_MAX_CHILDREN; i++)
+    {
+        lv_obj_t *child = lv_obj_get_child(ent->root, i);
+        if (!(child->flags & LV_OBJ_FLAG_HIDDEN))
+        {
+            child->flags |= LV_OBJ_FLAG_HIDDEN;
+            ent->hidden_mask |= 1u << i;
+        }
+    }
+}
+
+static void static_cache_children_restore(static_cache_entry_t *ent)
+{
+    for (uint32_t i = 0; i < STATIC_CACHE_MAX_CHILDREN && ent->hidden_mask != 0; i++)
+    {
+        if (ent->hidden_mask & (1u << i))
+        {
+            lv_obj_get_child(ent->root, i)->flags &= ~LV_OBJ_FLAG_HIDDEN;
+            ent->hidden_mask &= ~(1u << i);
+        }
+    }
+}
+
+// Pre-processed draw events of a cached root: on DRAW_MAIN_BEGIN blit the
+// snapshot and hide the children, then swallow the rest of this draw
+static void static_cache_draw_cb(lv_event_t *e)
+{
+    static_cache_entry_t *ent = lv_event_get_user_data(e);
+    const lv_event_code_t code = lv_event_get_code(e);
+
+    if (code == LV_EVENT_DRAW_MAIN_BEGIN)
+    {
+        if (s_snapshotting)
+        {
+            return;
+        }
+        if (!ent->valid)
+        {
+            s_stats.misses++;
+            return;
+        }
+
+        lv_area_t area;
+        const int32_t ext = lv_obj_get_ext_draw_size(ent->root);
+        lv_obj_get_coords(ent->root, &area);
+        lv_area_increase(&area, ext, ext);
+
+        lv_draw_image_dsc_t dsc;
+        lv_draw_image_dsc_init(&dsc);
+        dsc.src = &ent->buf;
+        lv_draw_image(lv_event_get_layer(e), &dsc, &area);
+
+        static_cache_children_hide(ent);
+        ent->blitting = true;
+        s_stats.hits++;
+        lv_event_stop_processing(e);
+        return;
+    }
+
+    if (!ent->blitting)
+    {
+        return;
+    }
+
+    if (code == LV_EVENT_DRAW_POST_END)
+    {
+        static_cache_children_restore(ent);
+        ent->blitting = false;
+    }
+    lv_event_stop_processing(e);
+}
+
+static void static_cache_delete_cb(lv_event_t *e)
+{
+    static_cache_entry_t *ent = lv_event_get_user_data(e);
+
+    if (ent->settle != NULL)
+    {
+        lv_timer_delete(ent->settle);
+    }
+    lv_image_cache_drop(&ent->buf);
+    free(ent->data);
+
+    s_stats.entries--;
+    s_stats.bytes -= ent->size;
+    memset(ent, 0, sizeof(*ent));
+}
+
+static bool static_cache_backdrop_is_black(lv_obj_t *obj)
+{
+    lv_obj_t *parent = lv_obj_get_parent(obj);
+    if (parent == NULL || lv_obj_get_style_bg_opa(parent, LV_PART_MAIN) != LV_OPA_COVER)
+    {
+        return false;
+    }
+
+    const lv_color_t c = lv_obj_get_style_bg_color(parent, LV_PART_MAIN);
+
+    return c.red == 0 && c.green == 0 && c.blue == 0;
+}
+
+bool static_cache_add(lv_obj_t *obj)
+{
+    static_cache_entry_t *ent = NULL;
+
+    for (int i = 0; i < STATIC_CACHE_MAX_ENTRIES && ent == NULL; i++)
+    {
+        if (s_entries[i].root == NULL)
+        {
+            ent = &s_entries[i];
+        }
+    }
+
+    if (ent == NULL || static_cache_find(obj) != NULL || !static_cache_backdrop_is_black(obj) ||
+        lv_obj_get_child_count(obj) > STATIC_CACHE_MAX_CHILDREN)
+    {
+        ESP_LOGW(TAG, "Not caching %p: no free entry, already cached or not on a black backdrop", (void *)obj);
+        return false;
+    }
+
+    lv_obj_update_layout(obj);
+    const int32_t ext = lv_obj_get_ext_draw_size(obj);
+    const uint32_t w = lv_obj_get_width(obj) + 2 * ext;
+    const uint32_t h = lv_obj_get_height(obj) + 2 * ext;
+    const uint32_t stride = lv_draw_buf_width_to_stride(w, LV_COLOR_FORMAT_RGB565);
+    const uint32_t size = stride * h;
+
+    if (s_stats.bytes + size > LCD_STATIC_CACHE_BUDGET)
+    {
+        ESP_LOGW(TAG, "Not caching %p: %u bytes would exceed the %u byte budget", (void *)obj,
+                 (unsigned)size, (unsigned)LCD_STATIC_CACHE_BUDGET);
+        return false;
+    }
+
+    ent->data = malloc(size);
+    if (ent->data == NULL)
+    {
+        ESP_LOGW(TAG, "Not caching %p: no memory for %u bytes", (void *)obj, (unsigned)size);
+        return false;
+    }
+
+    ent->root = obj;
+    ent->size = size;
+    lv_draw_buf_init(&ent->buf, w, h, LV_COLOR_FORMAT_RGB565, stride, ent->data, size);
+
+    for (size_t i = 0; i < sizeof(s_draw_events) / sizeof(s_draw_events[0]); i++)
+    {
+        lv_obj_add_event_cb(obj, static_cache_draw_cb, s_draw_events[i] | LV_EVENT_PREPROCESS, ent);
+    }
+    lv_obj_add_event_cb(obj, static_cache_delete_cb, LV_EVENT_DELETE, ent);
+    static_cache_watch(obj, ent);
+
+    s_stats.entries++;
+    s_stats.bytes += size;
+    static_cache_snapshot(ent);
+
+    ESP_LOGI(TAG, "Caching %p as %ux%u RGB565, %u bytes (%u in use)", (void *)obj, (unsigned)w, (unsigned)h,
+             (unsigned)size, (unsigned)s_stats.bytes);
+
+    return true;
+}
+
+void static_cache_invalidate(lv_obj_t *obj)
+{
+    static_cache_entry_t *ent = static_cache_find(obj);
+
+    if (ent != NULL)
+    {
+        static_cache_mark_stale(ent);
+    }
+}
+
+void static_cache_get_stats(static_cache_stats_t *stats)
+{
+    *stats = s_stats;
+}
+
+void static_cache_dump(void)
+{
+    const uint32_t draws = s_stats.hits + s_stats.misses;
+
+    ESP_LOGI(TAG, "%u subtrees, %u bytes, %u snapshots, %u/%u draws cached (%u%% hit rate)",
+             (unsigned)s_stats.entries, (unsigned)s_stats.bytes, (unsigned)s_stats.snapshots,
+             (unsigned)s_stats.hits, (unsigned)draws, draws ? (unsigned)(s_stats.hits * 100 / draws) : 0);
+}
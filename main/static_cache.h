@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <lvgl.h>
+
+// Snapshot cache for subtrees of the screen that rarely change. A cached
+// object and its children are drawn as one RGB565 blit instead of running
+// the style/draw pipeline for every object, whenever anything overlapping
+// them is redrawn.
+//
+// A subtree goes back to live rendering as soon as one of its objects reports
+// a style, state, size, value or child change, and is snapshotted again after
+// LCD_STATIC_CACHE_SETTLE_MS without further changes. Content changes that
+// LVGL does not signal (e.g. lv_label_set_text()) need static_cache_invalidate().
+//
+// Snapshots are opaque and rendered over black, so only subtrees whose parent
+// has an opaque black background are accepted.
+
+typedef struct {
+    uint32_t entries;     // Subtrees registered
+    uint32_t bytes;       // Snapshot memory in use
+    uint32_t snapshots;   // Snapshots taken since boot
+    uint32_t hits;        // Subtree draws served from a snapshot
+    uint32_t misses;      // Subtree draws rendered live because the snapshot was stale
+} static_cache_stats_t;
+
+// Cache obj and its children. Returns false, leaving obj rendered live, when
+// the backdrop is not black, the LCD_STATIC_CACHE_BUDGET is exhausted or the
+// snapshot buffer cannot be allocated.
+bool static_cache_add(lv_obj_t *obj);
+
+// Mark the cached subtree containing obj as changed
+void static_cache_invalidate(lv_obj_t *obj);
+
+void static_cache_get_stats(static_cache_stats_t *stats);
+
+// Write the stats to the log
+void static_cache_dump(void);
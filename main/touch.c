@@ -20,10 +20,16 @@ static uint16_t map(uint16_t n, uint16_t in_min, uint16_t in_max, uint16_t out_m
     return (value < out_min) ? out_min : ((value > out_max) ? out_max : value);
 }
 
+// Report touches in the unrotated LCD_H_RES x LCD_V_RES frame. Rotation is done
+// by the panel (MADCTL) for pixels and by LVGL's pointer input for touches, so
+// the mapping here must not change with lcd_display_rotate().
 static void process_coordinates(esp_lcd_touch_handle_t tp, uint16_t *x, uint16_t *y, uint16_t *strength, uint8_t *point_num, uint8_t max_point_num)
 {
-    *x = map(*x, TOUCH_X_RES_MIN, TOUCH_X_RES_MAX, 0, LCD_H_RES);
-    *y = map(*y, TOUCH_Y_RES_MIN, TOUCH_Y_RES_MAX, 0, LCD_V_RES);
+    for (uint8_t i = 0; i < *point_num && i < max_point_num; i++)
+    {
+        x[i] = map(x[i], TOUCH_X_RES_MIN, TOUCH_X_RES_MAX, 0, LCD_H_RES - 1);
+        y[i] = map(y[i], TOUCH_Y_RES_MIN, TOUCH_Y_RES_MAX, 0, LCD_V_RES - 1);
+    }
 }
 
 esp_err_t app_touch_init(esp_lcd_touch_handle_t *tp)
@@ -0,0 +1,150 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <lvgl.h>
+
+#include "wifi_widget.h"
+
+#define WIFI_WIDGET_W        170
+#define WIFI_WIDGET_H        60
+#define WIFI_BAR_W           8
+#define WIFI_BAR_PITCH       12
+#define WIFI_BAR_X           10   // Left edge of the first bar
+#define WIFI_BAR_H(i)        (5 + ((i) + 1) * 3)
+
+typedef struct {
+    char text[48];   // "WiFi: <SSID>", only changed between frames
+    int bars;
+} wifi_widget_t;
+
+static lv_color_t wifi_widget_bar_color(int bar, int bars)
+{
+    if (bar >= bars)
+    {
+        return lv_color_hex(0x888888);
+    }
+
+    return (bars >= 3) ? lv_color_hex(0x00FF00) : (bars == 2) ? lv_color_hex(0xFFFF00) : lv_color_hex(0xFF8800);
+}
+
+static void wifi_widget_text_area(lv_obj_t *obj, lv_area_t *area)
+{
+    lv_obj_get_coords(obj, area);
+    area->y2 = area->y1 + lv_font_get_line_height(lv_obj_get_style_text_font(obj, LV_PART_MAIN)) - 1;
+}
+
+// Bars stand on the bottom edge, the tallest one bounds them
+static void wifi_widget_bar_area(lv_obj_t *obj, int bar, lv_area_t *area)
+{
+    lv_obj_get_coords(obj, area);
+    area->x1 += WIFI_BAR_X + bar * WIFI_BAR_PITCH;
+    area->x2 = area->x1 + WIFI_BAR_W - 1;
+    area->y1 = area->y2 - WIFI_BAR_H(bar) + 1;
+}
+
+static void wifi_widget_event_cb(lv_event_t *e)
+{
+    lv_obj_t *obj = lv_event_get_current_target(e);
+    wifi_widget_t *ww = lv_obj_get_user_data(obj);
+
+    if (lv_event_get_code(e) == LV_EVENT_DELETE)
+    {
+        free(ww);
+        return;
+    }
+
+    lv_layer_t *layer = lv_event_get_layer(e);
+    lv_area_t area;
+
+    wifi_widget_text_area(obj, &area);
+    lv_draw_label_dsc_t label;
+    lv_draw_label_dsc_init(&label);
+    label.font = lv_obj_get_style_text_font(obj, LV_PART_MAIN);
+    label.color = lv_obj_get_style_text_color(obj, LV_PART_MAIN);
+    label.text = ww->text;
+    label.flag = LV_TEXT_FLAG_EXPAND;   // One line, a long SSID is clipped at the edge
+    lv_draw_label(layer, &label, &area);
+
+    lv_draw_rect_dsc_t rect;
+    lv_draw_rect_dsc_init(&rect);
+    rect.radius = 1;
+    for (int i = 0; i < WIFI_WIDGET_BARS; i++)
+    {
+        wifi_widget_bar_area(obj, i, &area);
+        rect.bg_color = wifi_widget_bar_color(i, ww->bars);
+        lv_draw_rect(layer, &rect, &area);
+    }
+}
+
+lv_obj_t *wifi_widget_create(lv_obj_t *parent)
+{
+    wifi_widget_t *ww = calloc(1, sizeof(*ww));
+    if (ww == NULL)
+    {
+        return NULL;
+    }
+
+    snprintf(ww->text, sizeof(ww->text), "WiFi: Not Connected");
+
+    lv_obj_t *obj = lv_obj_create(parent);
+    lv_obj_remove_style_all(obj);
+    lv_obj_remove_flag(obj, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_size(obj, WIFI_WIDGET_W, WIFI_WIDGET_H);
+    lv_obj_set_user_data(obj, ww);
+    lv_obj_add_event_cb(obj, wifi_widget_event_cb, LV_EVENT_DRAW_MAIN, NULL);
+    lv_obj_add_event_cb(obj, wifi_widget_event_cb, LV_EVENT_DELETE, NULL);
+
+    return obj;
+}
+
+void wifi_widget_set_ssid(lv_obj_t *obj, const char *ssid)
+{
+    wifi_widget_t *ww = lv_obj_get_user_data(obj);
+    char text[sizeof(ww->text)];
+
+    snprintf(text, sizeof(text), "WiFi: %s", (ssid != NULL) ? ssid : "Not Connected");
+    if (strcmp(text, ww->text) == 0)
+    {
+        return;
+    }
+
+    strcpy(ww->text, text);
+
+    lv_area_t area;
+    wifi_widget_text_area(obj, &area);
+    lv_obj_invalidate_area(obj, &area);
+}
+
+void wifi_widget_set_bars(lv_obj_t *obj, int bars)
+{
+    wifi_widget_t *ww = lv_obj_get_user_data(obj);
+
+    bars = LV_CLAMP(0, bars, WIFI_WIDGET_BARS);
+    if (bars == ww->bars)
+    {
+        return;
+    }
+
+    // Every lit bar changes colour when the level crosses 2 or 3
+    lv_area_t area;
+    lv_area_t last;
+    wifi_widget_bar_area(obj, 0, &area);
+    wifi_widget_bar_area(obj, WIFI_WIDGET_BARS - 1, &last);
+    area.x2 = last.x2;
+    area.y1 = last.y1;
+
+    ww->bars = bars;
+    lv_obj_invalidate_area(obj, &area);
+}
+
+int wifi_widget_bars_from_rssi(int rssi)
+{
+    // RSSI ranges typically from -30 (excellent) to -90 (unusable)
+    if (rssi >= -55) return 4;      // Excellent: -55 to -30 dBm
+    if (rssi >= -67) return 3;      // Good: -67 to -56 dBm
+    if (rssi >= -77) return 2;      // Fair: -77 to -68 dBm
+    if (rssi >= -87) return 1;      // Poor: -87 to -78 dBm
+
+    return 0;                       // No bars: < -88 dBm
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <lvgl.h>
+
+// WiFi status: "WiFi: <SSID>" above four signal bars, as one object drawn
+// in one callback instead of a panel, a label and four bar objects. Text
+// font and colour come from the object's style, like a label's. Setting a
+// value that is already shown does nothing; a change invalidates only the
+// text line or only the bars.
+
+#define WIFI_WIDGET_BARS  4
+
+// Create the widget, 170 x 60 like the panel it replaces, showing no connection
+lv_obj_t *wifi_widget_create(lv_obj_t *parent);
+
+// Show ssid, NULL when not connected
+void wifi_widget_set_ssid(lv_obj_t *obj, const char *ssid);
+
+// Show bars of WIFI_WIDGET_BARS lit: green for 3 or 4, yellow for 2, orange for 1
+void wifi_widget_set_bars(lv_obj_t *obj, int bars);
+
+// Signal bars for an RSSI in dBm: -55 and up is 4, below -87 is 0
+int wifi_widget_bars_from_rssi(int rssi);
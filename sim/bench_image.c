@@ -0,0 +1,138 @@
+// Decode throughput of compressed RGB565 images (main/img_rle565.c) against
+// the same pixels as a plain lv_image_dsc_t, which LVGL reads in place.
+//
+// bench_panel.png stands in for full-width artwork and water_drop.png for the
+// icons on the water-control screen; both are converted at build time with
+// --raw so each image exists in both forms.
+//
+//   ./build-sim/cyd_bench_image
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <lvgl.h>
+
+#include "hardware.h"
+#include "img_rle565.h"
+#include "lcd.h"
+#include "sim.h"
+
+LV_IMAGE_DECLARE(img_bench_panel);
+LV_IMAGE_DECLARE(img_bench_panel_raw);
+LV_IMAGE_DECLARE(img_water_drop);
+LV_IMAGE_DECLARE(img_water_drop_raw);
+
+#define BENCH_DECODE_ITERS  2000
+#define BENCH_DRAW_ITERS    200
+
+// Decode the whole image into RGB565 (+ A8) planes and compare with the raw copy
+static bool bench_verify(const img_rle565_t *img, const lv_image_dsc_t *raw)
+{
+    const uint32_t px = img->w * img->h;
+    uint8_t *out = malloc(px * 3);
+
+    img_rle565_decode_rows(img, 0, img->h, (uint16_t *)out, img->w * 2, out + px * 2, img->w);
+    bool ok = memcmp(out, raw->data, raw->data_size) == 0;
+
+    // Bands that start mid-block must match too
+    for (int32_t y = 0; ok && y < img->h; y += 3) {
+        int32_t rows = LV_MIN(5, img->h - y);
+        img_rle565_decode_rows(img, y, rows, (uint16_t *)out, img->w * 2, out + rows * img->w * 2, img->w);
+        ok = memcmp(out, raw->data + y * img->w * 2, rows * img->w * 2) == 0;
+    }
+
+    free(out);
+    return ok;
+}
+
+static void bench_decode(const char *title, const lv_image_dsc_t *rle, const lv_image_dsc_t *raw)
+{
+    img_rle565_t img;
+
+    if (!img_rle565_parse(&img, rle->data, rle->data_size)) {
+        printf("  %-12s not an img_rle565 stream\n", title);
+        return;
+    }
+
+    const uint32_t px = img.w * img.h;
+    const int32_t band = img.block_rows;
+    uint8_t *out = malloc(img.w * band * 3);
+
+    // Band by band, as the LVGL decoder feeds the renderer
+    uint64_t start = sim_now_ns();
+    for (int i = 0; i < BENCH_DECODE_ITERS; i++) {
+        for (int32_t y = 0; y < img.h; y += band) {
+            int32_t rows = LV_MIN(band, img.h - y);
+            img_rle565_decode_rows(&img, y, rows, (uint16_t *)out, img.w * 2, out + rows * img.w * 2, img.w);
+        }
+    }
+    double rle_ns = (double)(sim_now_ns() - start) / BENCH_DECODE_ITERS / px;
+
+    // Baseline: copying the same bands out of the raw image
+    start = sim_now_ns();
+    for (int i = 0; i < BENCH_DECODE_ITERS; i++) {
+        for (int32_t y = 0; y < img.h; y += band) {
+            int32_t rows = LV_MIN(band, img.h - y);
+            memcpy(out, raw->data + y * img.w * 2, rows * img.w * 2);
+            if (img.alpha) {
+                memcpy(out + rows * img.w * 2, raw->data + px * 2 + y * img.w, rows * img.w);
+            }
+        }
+    }
+    double raw_ns = (double)(sim_now_ns() - start) / BENCH_DECODE_ITERS / px;
+    free(out);
+
+    printf("  %-12s %3dx%-3d %6u -> %5u bytes  decode %5.2f ns/px (%6.1f Mpx/s), raw copy %5.2f ns/px  %s\n",
+           title, (int)img.w, (int)img.h, (unsigned)raw->data_size, (unsigned)rle->data_size,
+           rle_ns, 1e3 / rle_ns, raw_ns, bench_verify(&img, raw) ? "ok" : "MISMATCH");
+}
+
+// Full redraw of a screen showing only src, tiled to cover the panel
+static double bench_draw(lv_display_t *disp, const lv_image_dsc_t *src)
+{
+    lv_obj_t *prev = lv_screen_active();
+    lv_obj_t *scr = lv_obj_create(NULL);
+    lv_obj_set_style_bg_color(scr, lv_color_black(), LV_PART_MAIN);
+    lv_obj_set_flex_flow(scr, LV_FLEX_FLOW_ROW_WRAP);
+    lv_obj_set_style_pad_all(scr, 0, LV_PART_MAIN);
+    lv_obj_set_style_pad_gap(scr, 0, LV_PART_MAIN);
+    lv_obj_remove_flag(scr, LV_OBJ_FLAG_SCROLLABLE);
+
+    for (int32_t n = (LCD_H_RES / src->header.w + 1) * (LCD_V_RES / src->header.h + 1); n > 0; n--) {
+        lv_obj_t *img = lv_image_create(scr);
+        lv_image_set_src(img, src);
+    }
+    lv_screen_load(scr);
+    lv_refr_now(disp);
+
+    uint64_t start = sim_now_ns();
+    for (int i = 0; i < BENCH_DRAW_ITERS; i++) {
+        lv_obj_invalidate(scr);
+        lv_refr_now(disp);
+    }
+    double frame_us = (double)(sim_now_ns() - start) / BENCH_DRAW_ITERS / 1000.0;
+
+    lv_screen_load(prev);
+    lv_obj_delete(scr);
+
+    return frame_us;
+}
+
+int main(void)
+{
+    sim_display_set_verbose(false);
+    lv_display_t *disp = app_lvgl_init(NULL, NULL);
+
+    printf("band decode vs raw, %d iterations\n", BENCH_DECODE_ITERS);
+    bench_decode("panel", &img_bench_panel, &img_bench_panel_raw);
+    bench_decode("water drop", &img_water_drop, &img_water_drop_raw);
+
+    printf("\nfull-screen redraw through LVGL, images tiled, %d iterations\n", BENCH_DRAW_ITERS);
+    printf("  %-12s %8.1f us/frame compressed  %8.1f us/frame raw\n", "panel",
+           bench_draw(disp, &img_bench_panel), bench_draw(disp, &img_bench_panel_raw));
+    printf("  %-12s %8.1f us/frame compressed  %8.1f us/frame raw\n", "water drop",
+           bench_draw(disp, &img_water_drop), bench_draw(disp, &img_water_drop_raw));
+
+    return 0;
+}
@@ -0,0 +1,137 @@
+// Full-screen redraw of the water-control screen, timed on the host.
+//
+// The number of LVGL software draw units is fixed at configure time
+// (SIM_DRAW_UNITS), so compare two build trees:
+//
+//   cmake -S sim -B build-sim   && cmake --build build-sim
+//   cmake -S sim -B build-sim-2 -DSIM_DRAW_UNITS=2 && cmake --build build-sim-2
+//   ./build-sim/cyd_bench_redraw; ./build-sim-2/cyd_bench_redraw
+//
+// Each screen is also redrawn with the solid-fill fast path (lcd_solid.c)
+// off, and a blank screen stands in for a clear before a screen change.
+//
+// Both themes are measured in one run (lcd_theme.c): the full-screen redraws,
+// and the frames rendered for one tap on the toggle button, which in the
+// default theme include its grow-on-press transform and transitions.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <lvgl.h>
+
+#include "hardware.h"
+#include "lcd_solid.h"
+#include "lcd_theme.h"
+#include "sim.h"
+
+void app_main(void);
+
+// Centre of toggle_btn as laid out in app_lvgl_main()
+#define BENCH_TOGGLE_X  (10 + 160 / 2)
+#define BENCH_TOGGLE_Y  (10 + 60 / 2)
+
+#define BENCH_ITERS     100
+
+static void bench_redraw_once(lv_display_t *disp, const char *title)
+{
+    // Warm up caches and glyph lookups
+    lv_obj_invalidate(lv_screen_active());
+    lv_refr_now(disp);
+
+    sim_display_reset_stats();
+    uint64_t start = sim_now_ns();
+    for (int i = 0; i < BENCH_ITERS; i++) {
+        lv_obj_invalidate(lv_screen_active());
+        lv_refr_now(disp);
+    }
+    double frame_us = (double)(sim_now_ns() - start) / BENCH_ITERS / 1000.0;
+
+    sim_stats_t stats;
+    sim_display_get_stats(&stats);
+    printf("  %-20s %8.1f us/frame  %7.1f fps  pipelined model %6.2f ms/frame  %4.1f fills/frame\n",
+           title, frame_us, 1e6 / frame_us,
+           stats.frames ? (double)stats.pipelined_ns / stats.frames / 1e6 : 0.0,
+           stats.frames ? (double)stats.fills / stats.frames : 0.0);
+}
+
+static void bench_redraw(lv_display_t *disp, const char *title)
+{
+    char name[32];
+
+    lcd_solid_set_enabled(false);
+    snprintf(name, sizeof(name), "%s", title);
+    bench_redraw_once(disp, name);
+
+    lcd_solid_set_enabled(true);
+    snprintf(name, sizeof(name), "%s, solid fill", title);
+    bench_redraw_once(disp, name);
+}
+
+// Render work for one tap on the toggle button, until it has settled
+static void bench_press(lv_display_t *disp)
+{
+    sim_display_reset_stats();
+    sim_touch_click(BENCH_TOGGLE_X, BENCH_TOGGLE_Y);
+    sim_run(LV_DEF_REFR_PERIOD * 2);
+
+    sim_stats_t stats;
+    sim_display_get_stats(&stats);
+    printf("  %-20s %8.1f us render  %4u frames  %7llu px flushed\n",
+           "tap", (double)stats.render_ns / 1000.0, (unsigned)stats.frames,
+           (unsigned long long)stats.pixels);
+}
+
+// The UI's two screens in the current theme; the valve is off before and after
+static void bench_theme(lv_display_t *disp)
+{
+    printf("%s theme\n", lcd_theme_is_lean() ? "lean" : "default");
+    bench_redraw(disp, "valve off");
+
+    bench_press(disp);
+    bench_redraw(disp, "valve on");
+
+    sim_touch_click(BENCH_TOGGLE_X, BENCH_TOGGLE_Y);
+    sim_run(LV_DEF_REFR_PERIOD * 2);
+}
+
+// An empty black screen, as shown for a moment when the UI switches screens
+static void bench_blank(lv_display_t *disp)
+{
+    lv_obj_t *prev = lv_screen_active();
+    lv_obj_t *scr = lv_obj_create(NULL);
+
+    lv_obj_set_style_bg_color(scr, lv_color_black(), LV_PART_MAIN);
+    lv_screen_load(scr);
+    bench_redraw(disp, "blank");
+
+    lv_screen_load(prev);
+    lv_obj_delete(scr);
+}
+
+int main(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-l") == 0 && i + 1 < argc) {
+            sim_display_set_buf_lines(atoi(argv[++i]));
+        } else {
+            fprintf(stderr, "usage: %s [-l lines]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    sim_display_set_verbose(false);
+    app_main();
+    lv_display_t *disp = lv_display_get_default();
+
+    printf("full-screen redraw, %dx%d, %d draw unit(s), %d iterations\n",
+           LCD_H_RES, LCD_V_RES, LV_DRAW_SW_DRAW_UNIT_CNT, BENCH_ITERS);
+    lcd_theme_set_lean(disp, false);
+    bench_theme(disp);
+    lcd_theme_set_lean(disp, true);
+    bench_theme(disp);
+
+    bench_blank(disp);
+
+    return 0;
+}
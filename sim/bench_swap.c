@@ -0,0 +1,83 @@
+// Per-pixel cost of getting a 240x320 frame into panel byte order. The device
+// renders RGB565_SWAPPED natively (LV_DRAW_SW_SUPPORT_RGB565_SWAPPED in
+// managed_components/lv_conf.h), so no swap pass runs there. Builds without
+// it render RGB565 and swap at flush with the 32-bit word kernel in
+// lcd_pixel.c; LVGL's lv_draw_sw_rgb565_swap() (the old swap_bytes path) is
+// timed alongside for comparison.
+
+#include <stdio.h>
+
+#include <lvgl.h>
+
+#include "hardware.h"
+#include "lcd_pixel.h"
+#include "sim.h"
+
+void app_main(void);
+
+#define BENCH_PX            (LCD_H_RES * LCD_V_RES)
+#define BENCH_KERNEL_ITERS  500
+#define BENCH_RENDER_ITERS  50
+
+static uint16_t s_frame[BENCH_PX];
+
+static double bench_kernel(sim_swap_kernel_t kernel)
+{
+    for (uint32_t i = 0; i < BENCH_PX; i++) {
+        s_frame[i] = (uint16_t)(i * 2654435761u);
+    }
+
+    uint64_t start = sim_now_ns();
+    for (int i = 0; i < BENCH_KERNEL_ITERS; i++) {
+        kernel(s_frame, BENCH_PX);
+    }
+
+    return (double)(sim_now_ns() - start) / ((double)BENCH_KERNEL_ITERS * BENCH_PX);
+}
+
+static double bench_render(lv_display_t *disp, lv_color_format_t cf, sim_swap_kernel_t kernel)
+{
+    lv_display_set_color_format(disp, cf);
+    sim_display_set_swap_kernel(kernel);
+
+    // Warm up caches and glyph lookups
+    lv_obj_invalidate(lv_screen_active());
+    lv_refr_now(disp);
+
+    uint64_t start = sim_now_ns();
+    for (int i = 0; i < BENCH_RENDER_ITERS; i++) {
+        lv_obj_invalidate(lv_screen_active());
+        lv_refr_now(disp);
+    }
+
+    return (double)(sim_now_ns() - start) / ((double)BENCH_RENDER_ITERS * BENCH_PX);
+}
+
+int main(void)
+{
+    sim_display_set_verbose(false);
+    app_main();
+    lv_display_t *disp = lv_display_get_default();
+
+    printf("byte swap only, %dx%d frame, %d iterations\n", LCD_H_RES, LCD_V_RES, BENCH_KERNEL_ITERS);
+    double lvgl_swap = bench_kernel(lv_draw_sw_rgb565_swap);
+    double word_swap = bench_kernel(lcd_pixel_swap_rgb565);
+    printf("  lv_draw_sw_rgb565_swap       %6.3f ns/px\n", lvgl_swap);
+    printf("  lcd_pixel_swap_rgb565        %6.3f ns/px  (%.2fx)\n", word_swap, lvgl_swap / word_swap);
+
+    printf("\nfull-screen render + flush, %d iterations\n", BENCH_RENDER_ITERS);
+    double render_lvgl = bench_render(disp, LV_COLOR_FORMAT_RGB565, lv_draw_sw_rgb565_swap);
+    double render_word = bench_render(disp, LV_COLOR_FORMAT_RGB565, lcd_pixel_swap_rgb565);
+#if LCD_PIXEL_NATIVE_SWAPPED
+    double render_native = bench_render(disp, LV_COLOR_FORMAT_RGB565_SWAPPED, lcd_pixel_swap_rgb565);
+    printf("  RGB565_SWAPPED native        %6.3f ns/px  (device path)\n", render_native);
+    printf("  RGB565 + word swap           %6.3f ns/px  (%.2fx, fallback)\n", render_word, render_word / render_native);
+    printf("  RGB565 + lv_draw_sw swap     %6.3f ns/px  (%.2fx)\n", render_lvgl, render_lvgl / render_native);
+#else
+    printf("  RGB565_SWAPPED native        not supported by this LVGL build\n");
+    printf("  RGB565 + word swap           %6.3f ns/px  (device path in this build)\n", render_word);
+    printf("  RGB565 + lv_draw_sw swap     %6.3f ns/px  (%.2fx)\n", render_lvgl, render_lvgl / render_word);
+#endif
+
+    return 0;
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+// The few MIPI DCS commands main/ sends outside the panel driver
+#define LCD_CMD_SLPIN   0x10
+#define LCD_CMD_SLPOUT  0x11
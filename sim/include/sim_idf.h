@@ -0,0 +1,142 @@
+#pragma once
+
+// Minimal stand-ins for the ESP-IDF and FreeRTOS APIs used by main/, so the UI
+// code can be compiled unchanged for the host simulator.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef int esp_err_t;
+
+#define ESP_OK                          0
+#define ESP_FAIL                        -1
+#define ESP_ERR_NO_MEM                  0x101
+#define ESP_ERR_INVALID_ARG             0x102
+#define ESP_ERR_INVALID_STATE           0x103
+#define ESP_ERR_INVALID_SIZE            0x104
+#define ESP_ERR_NOT_FOUND               0x105
+#define ESP_ERR_NOT_SUPPORTED           0x106
+#define ESP_ERR_TIMEOUT                 0x107
+#define ESP_ERR_NVS_BASE                0x1100
+#define ESP_ERR_NVS_NOT_FOUND           (ESP_ERR_NVS_BASE + 0x02)
+#define ESP_ERR_NVS_NO_FREE_PAGES       (ESP_ERR_NVS_BASE + 0x0d)
+#define ESP_ERR_NVS_NEW_VERSION_FOUND   (ESP_ERR_NVS_BASE + 0x10)
+
+const char *esp_err_to_name(esp_err_t code);
+
+void sim_log(char level, const char *tag, const char *format, ...);
+
+#define ESP_LOGE(tag, format, ...) sim_log('E', tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) sim_log('W', tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) sim_log('I', tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) do { (void)(tag); } while (0)
+#define ESP_LOGV(tag, format, ...) do { (void)(tag); } while (0)
+
+#define ESP_ERROR_CHECK(x) do {                                             \
+        esp_err_t err_rc_ = (x);                                            \
+        if (err_rc_ != ESP_OK) {                                            \
+            fprintf(stderr, "ESP_ERROR_CHECK failed: %s at %s:%d\n",        \
+                    esp_err_to_name(err_rc_), __FILE__, __LINE__);          \
+            abort();                                                        \
+        }                                                                   \
+    } while (0)
+
+#define ESP_RETURN_ON_ERROR(x, log_tag, format, ...) do {                   \
+        esp_err_t err_rc_ = (x);                                            \
+        if (err_rc_ != ESP_OK) {                                            \
+            ESP_LOGE(log_tag, format, ##__VA_ARGS__);                       \
+            return err_rc_;                                                 \
+        }                                                                   \
+    } while (0)
+
+#define ESP_RETURN_ON_FALSE(a, err_code, log_tag, format, ...) do {         \
+        if (!(a)) {                                                         \
+            ESP_LOGE(log_tag, format, ##__VA_ARGS__);                       \
+            return err_code;                                                \
+        }                                                                   \
+    } while (0)
+
+#define ESP_GOTO_ON_ERROR(x, goto_tag, log_tag, format, ...) do {         \
+        esp_err_t err_rc_ = (x);                                            \
+        if (err_rc_ != ESP_OK) {                                            \
+            ESP_LOGE(log_tag, format, ##__VA_ARGS__);                       \
+            ret = err_rc_;                                                  \
+            goto goto_tag;                                                  \
+        }                                                                   \
+    } while (0)
+
+#define ESP_GOTO_ON_FALSE(a, err_code, goto_tag, log_tag, format, ...) do { \
+        if (!(a)) {                                                         \
+            ESP_LOGE(log_tag, format, ##__VA_ARGS__);                       \
+            ret = err_code;                                                 \
+            goto goto_tag;                                                  \
+        }                                                                   \
+    } while (0)
+
+// Heap capabilities do not matter on the host
+#define MALLOC_CAP_DMA                  (1 << 3)
+#define MALLOC_CAP_INTERNAL             (1 << 11)
+#define heap_caps_malloc(size, caps)    malloc(size)
+#define heap_caps_free(ptr)             free(ptr)
+
+// esp_timer: host monotonic clock in microseconds
+int64_t esp_timer_get_time(void);
+
+// FreeRTOS
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef void *TaskHandle_t;
+typedef void *SemaphoreHandle_t;
+typedef void *EventGroupHandle_t;
+typedef uint32_t EventBits_t;
+
+#define pdTRUE              1
+#define pdFALSE             0
+#define pdPASS              pdTRUE
+#define portMAX_DELAY       ((TickType_t)0xffffffffUL)
+#define configTICK_RATE_HZ  1000
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(ms))
+#define BIT0                0x00000001
+#define BIT1                0x00000002
+
+// The simulator is single-threaded, so critical sections are no-ops
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED    0
+#define portENTER_CRITICAL(mux)         do { (void)(mux); } while (0)
+#define portEXIT_CRITICAL(mux)          do { (void)(mux); } while (0)
+#define portENTER_CRITICAL_SAFE(mux)    do { (void)(mux); } while (0)
+#define portEXIT_CRITICAL_SAFE(mux)     do { (void)(mux); } while (0)
+
+#define IRAM_ATTR
+
+// Advances the simulator's virtual clock; LVGL is not run while "sleeping"
+void vTaskDelay(TickType_t ticks);
+
+// Display and touch handles are opaque on the host
+typedef struct esp_lcd_panel_io_t *esp_lcd_panel_io_handle_t;
+typedef struct esp_lcd_panel_t *esp_lcd_panel_handle_t;
+typedef struct esp_lcd_touch_s *esp_lcd_touch_handle_t;
+
+// Direct panel writes outside LVGL's flush path, e.g. the boot splash; they
+// land in the simulated GRAM and count towards the bus totals (sim_display.c)
+esp_err_t esp_lcd_panel_draw_bitmap(esp_lcd_panel_handle_t panel, int x_start, int y_start, int x_end, int y_end,
+                                    const void *color_data);
+esp_err_t esp_lcd_panel_disp_on_off(esp_lcd_panel_handle_t panel, bool on_off);
+
+// Panel commands; SLPIN/SLPOUT are tracked so flushes to a sleeping panel are reported
+esp_err_t esp_lcd_panel_io_tx_param(esp_lcd_panel_io_handle_t io, int lcd_cmd, const void *param, size_t param_size);
+
+// WiFi station info
+typedef struct {
+    uint8_t ssid[33];
+    int8_t rssi;
+} wifi_ap_record_t;
+
+esp_err_t esp_wifi_sta_get_ap_info(wifi_ap_record_t *ap_info);
+
+// NVS
+esp_err_t nvs_flash_init(void);
+esp_err_t nvs_flash_erase(void);
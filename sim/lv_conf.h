@@ -0,0 +1,57 @@
+/**
+ * @file lv_conf.h
+ * LVGL configuration for the host simulator.
+ *
+ * Mirrors the device settings in sdkconfig that affect rendering cost;
+ * everything else keeps LVGL's defaults.
+ */
+
+#ifndef LV_CONF_H
+#define LV_CONF_H
+
+#define LV_COLOR_DEPTH 16
+
+/* The device allocates through main/lvgl_mem.c on heap_caps; the builtin
+ * pool stands in for it here */
+#define LV_USE_STDLIB_MALLOC    LV_STDLIB_BUILTIN
+#define LV_USE_STDLIB_STRING    LV_STDLIB_BUILTIN
+#define LV_USE_STDLIB_SPRINTF   LV_STDLIB_BUILTIN
+#define LV_MEM_SIZE (64 * 1024U)
+
+#define LV_DEF_REFR_PERIOD  33
+#define LV_DPI_DEF 130
+
+/* SIM_DRAW_UNITS comes from CMake; more than one needs threads, pthreads
+ * stand in for the FreeRTOS layer used on the device */
+#ifndef SIM_DRAW_UNITS
+#define SIM_DRAW_UNITS 1
+#endif
+
+#if SIM_DRAW_UNITS > 1
+#define LV_USE_OS   LV_OS_PTHREAD
+#else
+#define LV_USE_OS   LV_OS_NONE
+#endif
+
+#define LV_USE_DRAW_SW 1
+#define LV_DRAW_SW_DRAW_UNIT_CNT    SIM_DRAW_UNITS
+#define LV_DRAW_SW_COMPLEX          1
+#define LV_DRAW_SW_SHADOW_CACHE_SIZE 0
+#define LV_DRAW_SW_CIRCLE_CACHE_SIZE 4
+
+#define LV_USE_LOG 0
+
+#define LV_FONT_MONTSERRAT_14 1
+#define LV_FONT_MONTSERRAT_28 1
+#define LV_FONT_DEFAULT &lv_font_montserrat_14
+#define LV_USE_FONT_COMPRESSED 1
+
+#define LV_USE_THEME_DEFAULT 1
+#define LV_THEME_DEFAULT_DARK 1
+#define LV_THEME_DEFAULT_GROW 1
+#define LV_THEME_DEFAULT_TRANSITION_TIME 80
+
+#define LV_USE_OBSERVER 1
+#define LV_USE_SNAPSHOT 1
+
+#endif /*LV_CONF_H*/
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <lvgl.h>
+
+// Accounting collected by the framebuffer display driver
+typedef struct {
+    uint32_t frames;        // Refresh cycles that rendered something
+    uint32_t flushes;       // Flush callbacks, each one CASET/PASET/RAMWR sequence
+    uint32_t fills;         // Solid strips sent as fills, never rendered (lcd_solid.h)
+    uint64_t pixels;        // Pixels flushed to the panel
+    uint64_t bus_bytes;     // Bytes on the SPI bus, commands included
+    uint64_t bus_ns;        // Modelled SPI bus time
+    uint64_t render_ns;     // Host time spent rendering (flush callbacks included)
+    uint64_t serial_ns;     // Modelled frame time when each band waits for its DMA
+    uint64_t pipelined_ns;  // Modelled frame time with render/DMA overlap on two buffers
+} sim_stats_t;
+
+// Host monotonic clock in nanoseconds, for measuring render cost
+uint64_t sim_now_ns(void);
+
+// Virtual clock driving lv_tick
+uint32_t sim_time_ms(void);
+void sim_time_advance(uint32_t ms);
+
+// Run LVGL for the given amount of virtual time
+void sim_run(uint32_t ms);
+
+// Create the in-memory RGB565 display
+lv_display_t *sim_display_create(void);
+
+// lcd_solid_fill_cb_t: write a solid strip to the panel, costed like
+// lcd_flush_fill() on the device
+void sim_display_fill(lv_display_t *disp, const lv_area_t *area, lv_color_t color);
+
+// Panel contents as the ILI9341 would hold them (big-endian RGB565)
+const uint16_t *sim_display_framebuffer(void);
+
+// Print one line per rendered frame
+void sim_display_set_verbose(bool verbose);
+
+// Band height of the draw buffers, call before app_main()
+void sim_display_set_buf_lines(int lines);
+
+// Render into one full frame in direct mode and send only the dirty rows, as
+// the device does when the heap allows (LCD_DIRECT_MODE); call before app_main()
+void sim_display_set_direct(bool direct);
+bool sim_display_is_direct(void);
+
+// Byte-swap pass applied at flush when the display renders plain RGB565
+typedef void (*sim_swap_kernel_t)(void *buf, uint32_t px);
+void sim_display_set_swap_kernel(sim_swap_kernel_t kernel);
+
+// Scale host render time to approximate the ESP32 in the pipeline model
+void sim_display_set_cpu_scale(double scale);
+
+void sim_display_get_stats(sim_stats_t *stats);
+void sim_display_reset_stats(void);
+void sim_display_print_stats(const char *title);
+
+// Create the pointer input device standing in for the XPT2046
+lv_indev_t *sim_touch_create(void);
+
+// Press and release the simulated touch screen at (x, y)
+void sim_touch_click(int32_t x, int32_t y);
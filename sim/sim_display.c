@@ -0,0 +1,395 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <esp_lcd_panel_io.h>
+#include <esp_lcd_panel_ops.h>
+#include <esp_lcd_panel_commands.h>
+#include <lvgl.h>
+
+#include "hardware.h"
+#include "lcd_bus_cost.h"
+#include "lcd_hash.h"
+#include "lcd_pixel.h"
+#include "lcd_refresh.h"
+#include "lcd_rows.h"
+#include "lcd_stats.h"
+#include "sim.h"
+
+// Same banding as the device: two band buffers, LCD_BUF_LINES tall unless
+// overridden to emulate the height picked from the DMA heap at boot
+static uint16_t s_draw_buf[2][LCD_H_RES * LCD_BUF_LINES_MAX];
+static int s_buf_lines = LCD_BUF_LINES;
+static uint16_t s_framebuffer[LCD_H_RES * LCD_V_RES];
+
+static sim_stats_t s_total;
+static sim_stats_t s_frame;
+static uint64_t s_frame_start_ns;
+static bool s_verbose = true;
+static double s_cpu_scale = 1.0;
+static sim_swap_kernel_t s_swap_kernel = lcd_pixel_swap_rgb565;
+static bool s_panel_asleep;
+
+// Direct mode (sim_display_set_direct()): s_draw_buf[0] is one full frame,
+// and the rows LVGL rendered into it go out on the frame's last flush
+static bool s_direct;
+static lcd_rows_t s_rows;
+
+// Two-buffer pipeline model: band i renders into buffer i % 2 once the DMA
+// of band i - 2 has released it, and is flushed once band i - 1 is on the panel.
+static struct {
+    uint64_t mark_ns;       // Host time the current band started rendering
+    uint64_t render_end;    // Model time, relative to frame start
+    uint64_t dma_end;
+    uint64_t buf_free[2];
+    uint32_t band;
+} s_pipe;
+
+static void sim_pipe_band(uint64_t render_ns, uint64_t bus_ns)
+{
+    uint64_t *buf_free = &s_pipe.buf_free[(LCD_DOUBLE_BUFFER && !s_direct) ? s_pipe.band % 2 : 0];
+    uint64_t render_start = s_pipe.render_end > *buf_free ? s_pipe.render_end : *buf_free;
+
+    s_pipe.render_end = render_start + render_ns;
+    uint64_t dma_start = s_pipe.render_end > s_pipe.dma_end ? s_pipe.render_end : s_pipe.dma_end;
+    s_pipe.dma_end = dma_start + bus_ns;
+    *buf_free = s_pipe.dma_end;
+    s_pipe.band++;
+
+    s_frame.serial_ns += render_ns + bus_ns;
+}
+
+#if LCD_FLUSH_HASH
+// Compare the rows of area outside send (all of them without send) with the
+// framebuffer, in LVGL's byte order
+static void sim_check_unsent(lv_display_t *disp, const lv_area_t *area, const uint16_t *src, const lv_area_t *send)
+{
+    int32_t stride = lv_display_get_horizontal_resolution(disp);
+    int32_t w = lv_area_get_width(area);
+    bool swapped = lv_display_get_color_format(disp) == LV_COLOR_FORMAT_RGB565;
+
+    for (int32_t y = area->y1; y <= area->y2; y++) {
+        if (send != NULL && y >= send->y1 && y <= send->y2) {
+            continue;
+        }
+        const uint16_t *row = &src[(y - area->y1) * w];
+        const uint16_t *fb = &s_framebuffer[y * stride + area->x1];
+        for (int32_t x = 0; x < w; x++) {
+            uint16_t p = swapped ? (uint16_t)((row[x] << 8) | (row[x] >> 8)) : row[x];
+            if (p != fb[x]) {
+                printf("  warning: unsent row %d at (%d,%d) differs from the panel\n",
+                       (int)y, (int)(area->x1 + x), (int)y);
+                return;
+            }
+        }
+    }
+}
+#endif
+
+// Cost one w x h flush into the frame's stats and return its modelled bus time
+static uint64_t sim_flush_account(int32_t w, int32_t h)
+{
+    lcd_bus_cost_t cost = lcd_bus_cost_area(w, h);
+    s_frame.flushes++;
+    s_frame.pixels += (uint64_t)w * h;
+    s_frame.bus_bytes += cost.bytes;
+    s_frame.bus_ns += cost.time_ns;
+
+    // Same histograms as the device flush path; the DMA time is the modelled bus time
+    lcd_stats_record(LCD_STATS_FLUSH_AREA, w * h);
+    lcd_stats_record(LCD_STATS_FLUSH_BYTES, w * h * sizeof(uint16_t));
+    lcd_stats_record(LCD_STATS_DMA_US, cost.time_ns / 1000);
+
+    return cost.time_ns;
+}
+
+static void sim_flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+{
+    uint64_t band_render_ns = (uint64_t)((sim_now_ns() - s_pipe.mark_ns) * s_cpu_scale);
+    int32_t w = lv_area_get_width(area);
+    int32_t h = lv_area_get_height(area);
+    const uint16_t *src = (const uint16_t *)px_map;
+
+    if (s_panel_asleep) {
+        printf("  warning: flush of %dx%d at (%d,%d) while the panel is in SLPIN\n",
+               (int)w, (int)h, (int)area->x1, (int)area->y1);
+    }
+
+#if LCD_FLUSH_HASH
+    lv_area_t send;
+    bool any = lcd_hash_check(area, src, &send);
+
+    // Rows left out must really be on the panel already, or the hash lied
+    sim_check_unsent(disp, area, src, any ? &send : NULL);
+    if (!any) {
+        lv_display_flush_ready(disp);
+        s_pipe.mark_ns = sim_now_ns();
+        return;
+    }
+    src += (send.y1 - area->y1) * w;
+    px_map = (uint8_t *)src;
+    area = &send;
+    h = lv_area_get_height(area);
+#endif
+
+    // Keep the framebuffer in panel byte order, like the ILI9341's GRAM
+    if (lv_display_get_color_format(disp) == LV_COLOR_FORMAT_RGB565) {
+        s_swap_kernel(px_map, w * h);
+    }
+
+    // Addressed like GRAM under the current MADCTL: rows are as wide as LVGL's
+    // rotated horizontal resolution
+    int32_t stride = lv_display_get_horizontal_resolution(disp);
+    for (int32_t y = 0; y < h; y++) {
+        memcpy(&s_framebuffer[(area->y1 + y) * stride + area->x1], &src[y * w], w * sizeof(uint16_t));
+    }
+
+    sim_pipe_band(band_render_ns, sim_flush_account(w, h));
+
+    lv_display_flush_ready(disp);
+    s_pipe.mark_ns = sim_now_ns();
+}
+
+static void sim_flush_direct_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+{
+    int32_t stride = lv_display_get_horizontal_resolution(disp);
+    const uint16_t *frame = s_draw_buf[0];
+    uint64_t bus_ns = 0;
+
+    s_rows.width = stride;
+    lcd_rows_add(&s_rows, area->y1, area->y2);
+    if (!lv_display_flush_is_last(disp)) {
+        lv_display_flush_ready(disp);
+        return;
+    }
+
+    // One buffer: the whole frame is rendered before its rows go out
+    uint64_t render_ns = (uint64_t)((sim_now_ns() - s_pipe.mark_ns) * s_cpu_scale);
+
+    if (s_panel_asleep) {
+        printf("  warning: flush of %d row span(s) while the panel is in SLPIN\n", s_rows.count);
+    }
+
+    for (int i = 0; i < s_rows.count; i++) {
+        lv_area_t rows = { 0, s_rows.span[i].y1, stride - 1, s_rows.span[i].y2 };
+        const uint16_t *src = &frame[rows.y1 * stride];
+
+#if LCD_FLUSH_HASH
+        lv_area_t send;
+        bool any = lcd_hash_check(&rows, src, &send);
+
+        sim_check_unsent(disp, &rows, src, any ? &send : NULL);
+        if (!any) {
+            continue;
+        }
+        rows = send;
+        src = &frame[rows.y1 * stride];
+#endif
+
+        // The frame is LVGL's to draw on again, so swap the copy, not the source
+        int32_t h = lv_area_get_height(&rows);
+        memcpy(&s_framebuffer[rows.y1 * stride], src, stride * h * sizeof(uint16_t));
+        if (lv_display_get_color_format(disp) == LV_COLOR_FORMAT_RGB565) {
+            s_swap_kernel(&s_framebuffer[rows.y1 * stride], stride * h);
+        }
+        bus_ns += sim_flush_account(stride, h);
+    }
+
+    lcd_rows_reset(&s_rows, stride);
+    sim_pipe_band(render_ns, bus_ns);
+    lv_display_flush_ready(disp);
+}
+
+esp_err_t esp_lcd_panel_draw_bitmap(esp_lcd_panel_handle_t panel, int x_start, int y_start, int x_end, int y_end,
+                                    const void *color_data)
+{
+    lv_display_t *disp = lv_display_get_default();
+    int32_t stride = disp ? lv_display_get_horizontal_resolution(disp) : LCD_H_RES;
+    int32_t w = x_end - x_start;
+    int32_t h = y_end - y_start;
+    const uint16_t *src = color_data;
+
+    for (int32_t y = 0; y < h; y++) {
+        memcpy(&s_framebuffer[(y_start + y) * stride + x_start], &src[y * w], w * sizeof(uint16_t));
+    }
+
+    lcd_bus_cost_t cost = lcd_bus_cost_area(w, h);
+    s_total.flushes++;
+    s_total.pixels += (uint64_t)w * h;
+    s_total.bus_bytes += cost.bytes;
+    s_total.bus_ns += cost.time_ns;
+
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_disp_on_off(esp_lcd_panel_handle_t panel, bool on_off)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_io_tx_param(esp_lcd_panel_io_handle_t io, int lcd_cmd, const void *param, size_t param_size)
+{
+    if (lcd_cmd == LCD_CMD_SLPIN || lcd_cmd == LCD_CMD_SLPOUT) {
+        s_panel_asleep = (lcd_cmd == LCD_CMD_SLPIN);
+    }
+
+    return ESP_OK;
+}
+
+void sim_display_fill(lv_display_t *disp, const lv_area_t *area, lv_color_t color)
+{
+    int32_t w = lv_area_get_width(area);
+    int32_t h = lv_area_get_height(area);
+    int32_t stride = lv_display_get_horizontal_resolution(disp);
+    uint16_t px = lv_color_to_u16(color);
+
+    px = (uint16_t)((px >> 8) | (px << 8));
+    for (int32_t y = area->y1; y <= area->y2; y++) {
+        for (int32_t x = area->x1; x <= area->x2; x++) {
+            s_framebuffer[y * stride + x] = px;
+        }
+    }
+
+    // Queued ahead of the frame's first band, so it only delays the DMA side
+    lcd_bus_cost_t cost = lcd_bus_cost_fill(w, h, LCD_H_RES * LCD_SOLID_FILL_LINES);
+    s_frame.fills++;
+    s_frame.pixels += (uint64_t)w * h;
+    s_frame.bus_bytes += cost.bytes;
+    s_frame.bus_ns += cost.time_ns;
+    s_frame.serial_ns += cost.time_ns;
+    s_pipe.dma_end += cost.time_ns;
+    lcd_stats_record(LCD_STATS_FILL_AREA, w * h);
+#if LCD_FLUSH_HASH
+    lcd_hash_forget(area);
+#endif
+}
+
+static void sim_render_event_cb(lv_event_t *e)
+{
+    lv_event_code_t code = lv_event_get_code(e);
+
+    if (code == LV_EVENT_RENDER_START) {
+        memset(&s_frame, 0, sizeof(s_frame));
+        s_frame_start_ns = sim_now_ns();
+        memset(&s_pipe, 0, sizeof(s_pipe));
+        s_pipe.mark_ns = s_frame_start_ns;
+    } else if (code == LV_EVENT_RENDER_READY) {
+        s_frame.frames = 1;
+        s_frame.render_ns = sim_now_ns() - s_frame_start_ns;
+        s_frame.pipelined_ns = s_pipe.dma_end;
+        lcd_stats_record(LCD_STATS_RENDER_US, (uint32_t)(s_frame.render_ns / 1000));
+
+        if (s_verbose) {
+            printf("frame t=%6ums  render %8.1f us  flushes %3u  fills %3u  pixels %6llu  bus %8.1f us  serial %8.1f us  pipelined %8.1f us\n",
+                   sim_time_ms(), s_frame.render_ns / 1000.0, s_frame.flushes, s_frame.fills,
+                   (unsigned long long)s_frame.pixels, s_frame.bus_ns / 1000.0,
+                   s_frame.serial_ns / 1000.0, s_frame.pipelined_ns / 1000.0);
+        }
+
+        s_total.frames += s_frame.frames;
+        s_total.flushes += s_frame.flushes;
+        s_total.fills += s_frame.fills;
+        s_total.pixels += s_frame.pixels;
+        s_total.bus_bytes += s_frame.bus_bytes;
+        s_total.bus_ns += s_frame.bus_ns;
+        s_total.render_ns += s_frame.render_ns;
+        s_total.serial_ns += s_frame.serial_ns;
+        s_total.pipelined_ns += s_frame.pipelined_ns;
+    }
+}
+
+lv_display_t *sim_display_create(void)
+{
+    lv_display_t *disp = lv_display_create(LCD_H_RES, LCD_V_RES);
+
+    lv_display_set_color_format(disp, LCD_PIXEL_RENDER_FORMAT);
+    if (s_direct) {
+        lv_display_set_buffers(disp, s_draw_buf[0], NULL, sizeof(s_draw_buf[0]), LV_DISPLAY_RENDER_MODE_DIRECT);
+        lv_display_set_flush_cb(disp, sim_flush_direct_cb);
+        lcd_rows_reset(&s_rows, LCD_H_RES);
+    } else {
+        lv_display_set_buffers(disp, s_draw_buf[0], LCD_DOUBLE_BUFFER ? s_draw_buf[1] : NULL,
+                               LCD_H_RES * s_buf_lines * sizeof(uint16_t), LV_DISPLAY_RENDER_MODE_PARTIAL);
+        lv_display_set_flush_cb(disp, sim_flush_cb);
+    }
+    lv_display_add_event_cb(disp, sim_render_event_cb, LV_EVENT_RENDER_START, NULL);
+    lv_display_add_event_cb(disp, sim_render_event_cb, LV_EVENT_RENDER_READY, NULL);
+
+    return disp;
+}
+
+const uint16_t *sim_display_framebuffer(void)
+{
+    return s_framebuffer;
+}
+
+void sim_display_set_verbose(bool verbose)
+{
+    s_verbose = verbose;
+}
+
+void sim_display_set_buf_lines(int lines)
+{
+    if (lines < 1) {
+        lines = 1;
+    }
+    s_buf_lines = (lines > LCD_BUF_LINES_MAX) ? LCD_BUF_LINES_MAX : lines;
+}
+
+void sim_display_set_direct(bool direct)
+{
+    s_direct = direct;
+}
+
+bool sim_display_is_direct(void)
+{
+    return s_direct;
+}
+
+void sim_display_set_swap_kernel(sim_swap_kernel_t kernel)
+{
+    s_swap_kernel = kernel;
+}
+
+void sim_display_set_cpu_scale(double scale)
+{
+    s_cpu_scale = (scale > 0) ? scale : 1.0;
+}
+
+void sim_display_get_stats(sim_stats_t *stats)
+{
+    *stats = s_total;
+}
+
+void sim_display_reset_stats(void)
+{
+    memset(&s_total, 0, sizeof(s_total));
+}
+
+void sim_display_print_stats(const char *title)
+{
+    uint32_t frames = s_total.frames ? s_total.frames : 1;
+    lcd_refresh_info_t refr;
+
+    lcd_refresh_get_info(&refr);
+
+    if (s_direct) {
+        printf("\n%s (direct, full frame)\n", title);
+    } else {
+        printf("\n%s (%d-line bands)\n", title, s_buf_lines);
+    }
+    printf("  frames            %10u\n", s_total.frames);
+    printf("  flushes/frame     %10.1f\n", (double)s_total.flushes / frames);
+    printf("  fills/frame       %10.1f\n", (double)s_total.fills / frames);
+    printf("  pixels/frame      %10.0f\n", (double)s_total.pixels / frames);
+    printf("  render/frame      %10.1f us (host)\n", s_total.render_ns / 1000.0 / frames);
+    printf("  bus/frame         %10.1f us @ %u Hz\n", s_total.bus_ns / 1000.0 / frames,
+           lcd_bus_cost_get_pclk());
+    printf("  frame, serial     %10.1f us (render x%.1f + bus, one band at a time)\n",
+           s_total.serial_ns / 1000.0 / frames, s_cpu_scale);
+    printf("  frame, pipelined  %10.1f us (render overlapped with DMA)\n",
+           s_total.pipelined_ns / 1000.0 / frames);
+    printf("  bus total         %10.1f ms, %llu bytes\n", s_total.bus_ns / 1e6,
+           (unsigned long long)s_total.bus_bytes);
+    printf("  refresh period    %10u ms now (%s), %u rate changes so far\n", (unsigned)refr.period_ms,
+           refr.active ? "fast" : "idle", (unsigned)refr.switches);
+}
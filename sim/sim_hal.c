@@ -0,0 +1,287 @@
+// Host implementations of the board-support functions that demo.c calls:
+// display and touch bring-up, MQTT, WiFi, NVS and the LVGL lock.
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <esp_err.h>
+#include <esp_wifi.h>
+#include <nvs_flash.h>
+#include <lvgl.h>
+
+#include "hardware.h"
+#include "img_rle565.h"
+#include "lcd.h"
+#include "lcd_idle.h"
+#include "lcd_merge.h"
+#include "lcd_solid.h"
+#include "lcd_refresh.h"
+#include "lcd_theme.h"
+#include "touch.h"
+#include "mqtt_relay_client.h"
+#include "sim.h"
+
+static uint32_t s_time_ms;
+
+static lv_indev_state_t s_touch_state = LV_INDEV_STATE_RELEASED;
+static int s_brightness;
+static lv_point_t s_touch_point;
+
+static mqtt_state_change_callback_t s_mqtt_callback;
+
+uint64_t sim_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Counts from the first call, like esp_timer counting from boot
+int64_t esp_timer_get_time(void)
+{
+    static uint64_t boot_ns;
+
+    if (boot_ns == 0) {
+        boot_ns = sim_now_ns();
+    }
+
+    return (int64_t)((sim_now_ns() - boot_ns) / 1000);
+}
+
+uint32_t sim_time_ms(void)
+{
+    return s_time_ms;
+}
+
+void sim_time_advance(uint32_t ms)
+{
+    s_time_ms += ms;
+}
+
+void sim_run(uint32_t ms)
+{
+    // Step at the old esp_lvgl_port tick period; the device now wakes only when
+    // LVGL has work, which the virtual clock cannot tell apart
+    const uint32_t step_ms = 5;
+
+    for (uint32_t elapsed = 0; elapsed < ms; elapsed += step_ms) {
+        sim_time_advance(step_ms);
+        lv_timer_handler();
+    }
+}
+
+void sim_log(char level, const char *tag, const char *format, ...)
+{
+    va_list args;
+
+    fprintf(stderr, "%c (%u) %s: ", level, s_time_ms, tag);
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fputc('\n', stderr);
+}
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code) {
+    case ESP_OK:                return "ESP_OK";
+    case ESP_FAIL:              return "ESP_FAIL";
+    case ESP_ERR_NO_MEM:        return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG:   return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_NOT_FOUND:     return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_NOT_SUPPORTED: return "ESP_ERR_NOT_SUPPORTED";
+    default:                    return "ESP_ERR_UNKNOWN";
+    }
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    sim_time_advance(ticks);
+}
+
+esp_err_t nvs_flash_init(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_sta_get_ap_info(wifi_ap_record_t *ap_info)
+{
+    memset(ap_info, 0, sizeof(*ap_info));
+    strcpy((char *)ap_info->ssid, "cyd-sim");
+    ap_info->rssi = -60;
+
+    return ESP_OK;
+}
+
+// LVGL runs from a single thread here, so locking always succeeds
+bool app_lvgl_lock(uint32_t timeout_ms)
+{
+    return true;
+}
+
+void app_lvgl_unlock(void)
+{
+}
+
+// Nothing runs LVGL between app_lvgl_init() and here, so no frame was drawn yet
+void app_lvgl_show(lv_display_t *disp)
+{
+    lv_refr_now(disp);
+}
+
+esp_err_t app_lcd_init(esp_lcd_panel_io_handle_t *lcd_io, esp_lcd_panel_handle_t *lcd_panel)
+{
+    *lcd_io = NULL;
+    *lcd_panel = NULL;
+
+    return ESP_OK;
+}
+
+lv_display_t *app_lvgl_init(esp_lcd_panel_io_handle_t lcd_io, esp_lcd_panel_handle_t lcd_panel)
+{
+    lv_init();
+    lv_tick_set_cb(sim_time_ms);
+
+    lv_display_t *disp = sim_display_create();
+
+    // Same theme as the device build in lcd.c
+    lcd_theme_init(disp, LCD_THEME_LEAN);
+
+    img_rle565_decoder_init();
+
+#if LCD_REFR_GOVERNOR
+    lcd_refresh_governor_init(disp);
+#endif
+    // Both rework partial-mode bands, see app_lvgl_init() in lcd.c
+    if (!sim_display_is_direct()) {
+#if LCD_SOLID_FILL
+        lcd_solid_init(disp, sim_display_fill);
+#endif
+#if LCD_MERGE_COST_MODEL
+        lcd_merge_init(disp);
+#endif
+    }
+#if LCD_IDLE_SLEEP
+    // Simulated flushes land on the panel before flush_ready()
+    lcd_idle_init(disp, lcd_io, NULL);
+#endif
+
+    return disp;
+}
+
+esp_err_t lcd_display_brightness_init(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t lcd_display_brightness_set(int brightness_percent)
+{
+    s_brightness = brightness_percent;
+    return ESP_OK;
+}
+
+int lcd_display_brightness_get(void)
+{
+    return s_brightness;
+}
+
+esp_err_t lcd_display_backlight_off(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t lcd_display_backlight_on(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t lcd_display_rotate(lv_display_t *lvgl_disp, lv_display_rotation_t dir)
+{
+    if (lvgl_disp)
+    {
+        lv_display_set_rotation(lvgl_disp, dir);
+        return ESP_OK;
+    }
+
+    return ESP_FAIL;
+}
+
+static void sim_touch_read_cb(lv_indev_t *indev, lv_indev_data_t *data)
+{
+    data->point = s_touch_point;
+    data->state = s_touch_state;
+}
+
+lv_indev_t *sim_touch_create(void)
+{
+    lv_indev_t *indev = lv_indev_create();
+
+    lv_indev_set_type(indev, LV_INDEV_TYPE_POINTER);
+    lv_indev_set_read_cb(indev, sim_touch_read_cb);
+
+    return indev;
+}
+
+void sim_touch_click(int32_t x, int32_t y)
+{
+    s_touch_point.x = x;
+    s_touch_point.y = y;
+    s_touch_state = LV_INDEV_STATE_PRESSED;
+    sim_run(100);
+
+    s_touch_state = LV_INDEV_STATE_RELEASED;
+    sim_run(100);
+}
+
+esp_err_t app_touch_init(esp_lcd_touch_handle_t *tp)
+{
+    *tp = NULL;
+
+    return ESP_OK;
+}
+
+lv_indev_t *app_lvgl_add_touch(lv_display_t *lvgl_disp, esp_lcd_touch_handle_t tp)
+{
+    lv_indev_t *indev = sim_touch_create();
+
+#if LCD_REFR_GOVERNOR
+    lcd_refresh_governor_watch_indev(indev);
+#endif
+#if LCD_IDLE_SLEEP
+    lcd_idle_watch_indev(indev);
+#endif
+
+    return indev;
+}
+
+bool mqtt_init(void)
+{
+    return true;
+}
+
+bool mqtt_is_connected(void)
+{
+    return false;
+}
+
+void mqtt_publish_relay_state(uint8_t relay_num, bool state)
+{
+    ESP_LOGI("mqtt", "relay %u -> %s", relay_num, state ? "ON" : "OFF");
+}
+
+void mqtt_publish_all_relay_states(void)
+{
+}
+
+void mqtt_register_state_change_callback(mqtt_state_change_callback_t callback)
+{
+    s_mqtt_callback = callback;
+}
@@ -0,0 +1,169 @@
+// Headless host build of the water-control UI.
+//
+// Boots demo.c through app_main() against an in-memory RGB565 panel, then
+// replays a short session (idle, valve on, countdown, valve off, display
+// sleep and wake) and reports per-frame render time, flushed pixels and
+// modelled SPI bus time.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <lvgl.h>
+#include <src/core/lv_obj_private.h>
+#include <src/core/lv_obj_style_private.h>
+
+#include "hardware.h"
+#include "lcd_hash.h"
+#include "lcd_idle.h"
+#include "lcd_merge.h"
+#include "lcd_stats.h"
+#include "lcd_theme.h"
+#include "static_cache.h"
+#include "sim.h"
+
+void app_main(void);
+
+// Centre of toggle_btn as laid out in app_lvgl_main()
+#define SIM_TOGGLE_X  (10 + 160 / 2)
+#define SIM_TOGGLE_Y  (10 + 60 / 2)
+
+// Modelled bus time of the whole session, summed over the phases
+static uint64_t s_session_bus_ns;
+
+static void sim_phase_end(const char *title)
+{
+    sim_stats_t stats;
+
+    sim_display_print_stats(title);
+    sim_display_get_stats(&stats);
+    s_session_bus_ns += stats.bus_ns;
+    sim_display_reset_stats();
+}
+
+static void sim_count_objects(lv_obj_t *obj, uint32_t *objs, uint32_t *styles, uint32_t *local)
+{
+    (*objs)++;
+    *styles += obj->style_cnt;
+    for (uint32_t i = 0; i < obj->style_cnt; i++) {
+        *local += obj->styles[i].is_local;
+    }
+    for (uint32_t i = 0; i < lv_obj_get_child_count(obj); i++) {
+        sim_count_objects(lv_obj_get_child(obj, i), objs, styles, local);
+    }
+}
+
+// Objects on screen, the styles they reference (local ones each own a heap
+// allocated lv_style_t) and LVGL's heap, to measure the UI's memory cost
+static void sim_ui_report(void)
+{
+    uint32_t objs = 0;
+    uint32_t styles = 0;
+    uint32_t local = 0;
+    lv_mem_monitor_t mon;
+
+    sim_count_objects(lv_screen_active(), &objs, &styles, &local);
+    lv_mem_monitor(&mon);
+    printf("  ui                %10u objects, %u style refs, %u local styles\n",
+           (unsigned)objs, (unsigned)styles, (unsigned)local);
+    printf("  lvgl heap         %10u bytes used, %u peak, %u blocks\n",
+           (unsigned)(mon.total_size - mon.free_size), (unsigned)mon.max_used, (unsigned)mon.used_cnt);
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-q] [-d] [-m] [-s] [-t] [-c scale] [-l lines] [countdown_seconds]\n", prog);
+    fprintf(stderr, "  -q        summary only, no per-frame lines\n");
+    fprintf(stderr, "  -d        direct mode: one full frame, only dirty rows sent\n");
+    fprintf(stderr, "  -m        no bus-cost merging of dirty areas, to compare bus time\n");
+    fprintf(stderr, "  -s        no skipping of flushes already on the panel, to compare bus time\n");
+    fprintf(stderr, "  -t        switch theme after boot, lean <-> default (LCD_THEME_LEAN)\n");
+    fprintf(stderr, "  -c scale  multiply host render time by scale in the pipeline model\n");
+    fprintf(stderr, "  -l lines  draw buffer band height (default LCD_BUF_LINES)\n");
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t countdown_s = 10;
+    bool other_theme = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-q") == 0) {
+            sim_display_set_verbose(false);
+        } else if (strcmp(argv[i], "-d") == 0) {
+            sim_display_set_direct(true);
+        } else if (strcmp(argv[i], "-m") == 0) {
+            lcd_merge_set_enabled(false);
+        } else if (strcmp(argv[i], "-s") == 0) {
+            lcd_hash_set_enabled(false);
+        } else if (strcmp(argv[i], "-t") == 0) {
+            other_theme = true;
+        } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            sim_display_set_cpu_scale(atof(argv[++i]));
+        } else if (strcmp(argv[i], "-l") == 0 && i + 1 < argc) {
+            sim_display_set_buf_lines(atoi(argv[++i]));
+        } else if (argv[i][0] >= '0' && argv[i][0] <= '9') {
+            countdown_s = (uint32_t)atoi(argv[i]);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    printf("== boot\n");
+    app_main();
+    if (other_theme) {
+        lcd_theme_set_lean(lv_display_get_default(), !lcd_theme_is_lean());
+    }
+    sim_run(LV_DEF_REFR_PERIOD * 2);
+    sim_ui_report();
+    sim_phase_end("boot");
+
+    printf("\n== valve on, %us countdown\n", countdown_s);
+    sim_touch_click(SIM_TOGGLE_X, SIM_TOGGLE_Y);
+    sim_run(countdown_s * 1000);
+    sim_phase_end("countdown");
+
+    printf("\n== valve off\n");
+    sim_touch_click(SIM_TOGGLE_X, SIM_TOGGLE_Y);
+    sim_run(1000);
+    sim_phase_end("valve off");
+
+#if LCD_IDLE_SLEEP
+    lcd_idle_info_t idle;
+
+    printf("\n== idle %d s, display asleep\n", LCD_IDLE_TIMEOUT_MS / 1000);
+    sim_run(LCD_IDLE_TIMEOUT_MS + 1000);
+    lcd_idle_get_info(&idle);
+    printf("  asleep            %10s\n", idle.asleep ? "yes" : "no");
+    sim_phase_end("asleep");
+
+    // The waking press must not reach the toggle under it
+    printf("\n== wake on touch\n");
+    sim_touch_click(SIM_TOGGLE_X, SIM_TOGGLE_Y);
+    lcd_idle_get_info(&idle);
+    printf("  wake to frame     %10u us (host)\n", (unsigned)idle.last_wake_us);
+    sim_phase_end("wake");
+#endif
+
+    lcd_merge_info_t merge;
+    lcd_merge_get_info(&merge);
+    printf("\n== session\n");
+    printf("  bus total         %10.1f ms\n", s_session_bus_ns / 1e6);
+    sim_ui_report();
+    printf("  merged areas      %10u pairs in %u frames, %.1f ms bus time saved\n",
+           (unsigned)merge.merges, (unsigned)merge.frames, merge.saved_ns / 1e6);
+
+    lcd_hash_info_t hash;
+    lcd_hash_get_info(&hash);
+    printf("  unchanged skipped %10.1f KiB of %.1f KiB flushed (%u flushes dropped, %u trimmed)\n",
+           hash.skipped_bytes / 1024.0, hash.checked_bytes / 1024.0, (unsigned)hash.skipped,
+           (unsigned)hash.trimmed);
+
+    printf("\n== flush histograms (whole session)\n");
+    fflush(stdout);
+    lcd_stats_dump();
+    static_cache_dump();
+
+    return 0;
+}
@@ -0,0 +1,398 @@
+#!/usr/bin/env python3
+"""Subset one of LVGL's built-in bitmap fonts for main/fonts.txt.
+
+    font_subset.py <fonts.txt> <name> <lvgl_dir> <output.c>
+
+fonts.txt lists one font per line:
+
+    <name> <source> <glyphs> [compress]
+
+where <source> is a generated font in <lvgl_dir>/src/font (e.g.
+lv_font_montserrat_48.c), <glyphs> the characters to keep (no spaces) and
+`compress` stores the bitmaps in LVGL's RLE format with the line
+prefilter (bitmap_format 1, needs LV_USE_FONT_COMPRESSED). Kerning is kept
+for the glyph pairs that remain.
+
+Writes `const lv_font_t <name>` to output.c and prints how much flash the
+subset saves over the full source font.
+"""
+
+import os
+import re
+import sys
+
+GLYPH_DSC_SIZE = 8   # sizeof(lv_font_fmt_txt_glyph_dsc_t)
+CMAP_SIZE = 20       # sizeof(lv_font_fmt_txt_cmap_t) on a 32-bit target
+
+# LVGL's font RLE (lv_font_fmt_txt.c, rle_next()): after a repeated value,
+# up to 10 one-bits repeat it; the 11th is followed by a 6-bit counter
+RLE_BIT_REPEATS = 11
+RLE_COUNTER_MAX = 63
+
+
+def read_manifest(path, name):
+    with open(path, encoding="utf-8") as f:
+        for line in f:
+            fields = line.split("#", 1)[0].split()
+            if fields and fields[0] == name:
+                if len(fields) < 3:
+                    raise ValueError("%s: %s needs a source and a glyph list" % (path, name))
+                return fields[1], fields[2], "compress" in fields[3:]
+    raise ValueError("%s: no font named %s" % (path, name))
+
+
+def c_block(src, pattern):
+    m = re.search(pattern + r"\s*=\s*\{(.*?)\n\};", src, re.S)
+    return m.group(1) if m else None
+
+
+def c_fields(text):
+    return {k: v.strip() for k, v in re.findall(r"\.(\w+)\s*=\s*([^,}]+)", text)}
+
+
+def c_numbers(text):
+    return [int(v, 0) for v in re.findall(r"-?(?:0x[0-9a-fA-F]+|\d+)", text)]
+
+
+def parse_font(path):
+    with open(path, encoding="utf-8") as f:
+        src = re.sub(r"/\*.*?\*/", "", f.read(), flags=re.S)
+
+    font = {}
+    font["bitmap"] = bytes(c_numbers(c_block(src, r"glyph_bitmap\[\]")))
+    font["glyphs"] = []
+    for entry in re.findall(r"\{([^{}]*)\}", c_block(src, r"glyph_dsc\[\]")):
+        f = c_fields(entry)
+        font["glyphs"].append({k: int(f[k]) for k in ("bitmap_index", "adv_w", "box_w", "box_h", "ofs_x", "ofs_y")})
+
+    lists = {n: c_numbers(body) for n, body in re.findall(r"uint16_t (\w+)\[\]\s*=\s*\{(.*?)\};", src, re.S)}
+    font["cmap"] = {}
+    for entry in re.findall(r"\{([^{}]*)\}", c_block(src, r"cmaps\[\]")):
+        f = c_fields(entry)
+        start, length, gid = int(f["range_start"]), int(f["range_length"]), int(f["glyph_id_start"])
+        if f["type"] == "LV_FONT_FMT_TXT_CMAP_FORMAT0_TINY":
+            for i in range(length):
+                font["cmap"][start + i] = gid + i
+        elif f["type"] == "LV_FONT_FMT_TXT_CMAP_SPARSE_TINY":
+            for i, ofs in enumerate(lists[f["unicode_list"]]):
+                font["cmap"][start + ofs] = gid + i
+        else:
+            raise ValueError("%s: cmap type %s is not supported" % (path, f["type"]))
+    font["list_bytes"] = 2 * sum(len(v) for v in lists.values())
+    font["cmap_count"] = len(re.findall(r"\{([^{}]*)\}", c_block(src, r"cmaps\[\]")))
+
+    dsc = c_fields(c_block(src, r"lv_font_fmt_txt_dsc_t font_dsc"))
+    font["bpp"] = int(dsc["bpp"])
+    font["kern_scale"] = int(dsc.get("kern_scale", "16"))
+    if int(dsc.get("bitmap_format", "0")) != 0:
+        raise ValueError("%s: source bitmaps must be uncompressed" % path)
+
+    font["kern"] = None
+    if dsc.get("kern_classes") == "1":
+        kern = c_fields(c_block(src, r"lv_font_fmt_txt_kern_classes_t kern_classes"))
+        font["kern"] = {
+            "left": c_numbers(c_block(src, r"kern_left_class_mapping\[\]")),
+            "right": c_numbers(c_block(src, r"kern_right_class_mapping\[\]")),
+            "values": c_numbers(c_block(src, r"kern_class_values\[\]")),
+            "left_cnt": int(kern["left_class_cnt"]),
+            "right_cnt": int(kern["right_class_cnt"]),
+        }
+
+    pub = c_fields(re.search(r"const lv_font_t \w+\s*=\s*\{(.*?)\};", src, re.S).group(1))
+    font["metrics"] = {k: int(pub[k]) for k in ("line_height", "base_line", "underline_position", "underline_thickness")}
+    return font
+
+
+def font_size(font):
+    size = len(font["bitmap"]) + GLYPH_DSC_SIZE * len(font["glyphs"])
+    size += CMAP_SIZE * font["cmap_count"] + font["list_bytes"]
+    if font["kern"]:
+        k = font["kern"]
+        size += len(k["left"]) + len(k["right"]) + len(k["values"])
+    return size
+
+
+def glyph_pixels(font, g):
+    bpp = font["bpp"]
+    data = font["bitmap"][g["bitmap_index"]:]
+    px = []
+    for i in range(g["box_w"] * g["box_h"]):
+        bit = i * bpp
+        v = (data[bit >> 3] << 8 | (data[(bit >> 3) + 1] if (bit >> 3) + 1 < len(data) else 0))
+        px.append((v >> (16 - (bit & 7) - bpp)) & ((1 << bpp) - 1))
+    return px
+
+
+class BitWriter:
+    def __init__(self):
+        self.bits = []
+
+    def put(self, value, width):
+        self.bits.extend((value >> (width - 1 - i)) & 1 for i in range(width))
+
+    def bytes(self):
+        bits = self.bits + [0] * (-len(self.bits) % 8)
+        return bytes(int("".join(map(str, bits[i:i + 8])), 2) for i in range(0, len(bits), 8))
+
+
+def rle_encode(px, bpp):
+    """Encode for LVGL's rle_next(). Each run's first copy is written as a
+    plain value; writing it a second time switches the decoder to one-bit
+    repeats, and the value that ends a repeat is the next run's first copy."""
+    out = BitWriter()
+    out.put(px[0], bpp)
+    i = 0
+    while i < len(px):
+        v = px[i]
+        n = 1
+        while i + n < len(px) and px[i + n] == v:
+            n += 1
+        i += n
+        nxt = px[i] if i < len(px) else None
+
+        rest = n - 1
+        in_repeat = False
+        while rest > 0:
+            out.put(v, bpp)
+            rest -= 1
+            if rest < RLE_BIT_REPEATS:
+                # One-bits repeat v, a zero-bit ends the run
+                for _ in range(rest):
+                    out.put(1, 1)
+                rest = 0
+                in_repeat = True
+                break
+            # 11 one-bits plus a counter c repeat v 11 + (c - 1) times, then
+            # the decoder reads a plain value
+            c = min(rest - RLE_BIT_REPEATS + 1, RLE_COUNTER_MAX)
+            out.put((1 << RLE_BIT_REPEATS) - 1, RLE_BIT_REPEATS)
+            out.put(c, 6)
+            rest -= RLE_BIT_REPEATS + c - 1
+            if rest > 0:
+                # Counter too short: that plain value is another copy of v
+                out.put(v, bpp)
+                rest -= 1
+
+        if nxt is not None:
+            if in_repeat:
+                out.put(0, 1)
+            out.put(nxt, bpp)
+    return out.bytes()
+
+
+def rle_decode(data, bpp, count):
+    """Python port of LVGL's rle_next(), to check rle_encode()."""
+    pos = 0
+
+    def get(width):
+        nonlocal pos
+        v = 0
+        for _ in range(width):
+            byte = data[pos >> 3] if (pos >> 3) < len(data) else 0
+            v = (v << 1) | ((byte >> (7 - (pos & 7))) & 1)
+            pos += 1
+        return v
+
+    out = []
+    state, prev, cnt = "single", 0, 0
+    for _ in range(count):
+        if state == "single":
+            start = pos
+            ret = get(bpp)
+            if start != 0 and prev == ret:
+                cnt, state = 0, "repeat"
+            prev = ret
+        elif state == "repeat":
+            cnt += 1
+            if get(1):
+                ret = prev
+                if cnt == RLE_BIT_REPEATS:
+                    cnt = get(6)
+                    if cnt:
+                        state = "counter"
+                    else:
+                        ret = prev = get(bpp)
+                        state = "single"
+            else:
+                ret = prev = get(bpp)
+                state = "single"
+        else:
+            ret = prev
+            cnt -= 1
+            if cnt == 0:
+                ret = prev = get(bpp)
+                state = "single"
+        out.append(ret)
+    return out
+
+
+def compress_glyph(px, w, bpp):
+    # Prefilter: each row XOR the row above (LV_FONT_FMT_TXT_COMPRESSED)
+    filtered = px[:w] + [px[i] ^ px[i - w] for i in range(w, len(px))]
+    data = rle_encode(filtered, bpp)
+    if rle_decode(data, bpp, len(filtered)) != filtered:
+        raise AssertionError("RLE round trip failed")
+    return data
+
+
+def subset(font, glyphs, compress):
+    codes = sorted({ord(c) for c in glyphs})
+    missing = [c for c in codes if c not in font["cmap"]]
+    if missing:
+        raise ValueError("glyphs not in the source font: %s" % "".join(map(chr, missing)))
+
+    bpp = font["bpp"]
+    bitmap = bytearray()
+    dscs = [dict(bitmap_index=0, adv_w=0, box_w=0, box_h=0, ofs_x=0, ofs_y=0)]
+    old_ids = [0]
+    for code in codes:
+        gid = font["cmap"][code]
+        g = dict(font["glyphs"][gid])
+        px = glyph_pixels(font, g)
+        if compress and px:
+            data = compress_glyph(px, g["box_w"], bpp)
+        else:
+            data = font["bitmap"][g["bitmap_index"]:g["bitmap_index"] + (len(px) * bpp + 7) // 8]
+        g["bitmap_index"] = len(bitmap)
+        bitmap += data
+        dscs.append(g)
+        old_ids.append(gid)
+    # The decoder may read one byte past the last glyph
+    bitmap.append(0)
+
+    kern = None
+    if font["kern"]:
+        k = font["kern"]
+        lefts = sorted({k["left"][g] for g in old_ids if k["left"][g]})
+        rights = sorted({k["right"][g] for g in old_ids if k["right"][g]})
+        values = [k["values"][(l - 1) * k["right_cnt"] + (r - 1)] for l in lefts for r in rights]
+        if any(values):
+            kern = {
+                "left": [lefts.index(k["left"][g]) + 1 if k["left"][g] else 0 for g in old_ids],
+                "right": [rights.index(k["right"][g]) + 1 if k["right"][g] else 0 for g in old_ids],
+                "values": values,
+                "left_cnt": len(lefts),
+                "right_cnt": len(rights),
+            }
+
+    contiguous = codes[-1] - codes[0] + 1 == len(codes)
+    return {
+        "codes": codes,
+        "bitmap": bytes(bitmap),
+        "glyphs": dscs,
+        "kern": kern,
+        "contiguous": contiguous,
+        "cmap_count": 1,
+        "list_bytes": 0 if contiguous else 2 * len(codes),
+        "bpp": bpp,
+        "kern_scale": font["kern_scale"],
+        "metrics": font["metrics"],
+        "compress": compress,
+    }
+
+
+def c_bytes(values, per_line=16, fmt="0x%02x"):
+    return "\n".join("    " + ", ".join(fmt % v for v in values[i:i + per_line]) + ","
+                     for i in range(0, len(values), per_line))
+
+
+def write_font(path, name, source, sub):
+    codes = sub["codes"]
+    out = [
+        "// Generated by tools/font_subset.py from %s, do not edit" % source,
+        "// Glyphs: %s" % "".join(chr(c) for c in codes),
+        "",
+        "#include <lvgl.h>",
+        "",
+        "static const uint8_t glyph_bitmap[] = {",
+        c_bytes(sub["bitmap"]),
+        "};",
+        "",
+        "static const lv_font_fmt_txt_glyph_dsc_t glyph_dsc[] = {",
+    ]
+    for g in sub["glyphs"]:
+        out.append("    {.bitmap_index = %d, .adv_w = %d, .box_w = %d, .box_h = %d, .ofs_x = %d, .ofs_y = %d}," % (
+            g["bitmap_index"], g["adv_w"], g["box_w"], g["box_h"], g["ofs_x"], g["ofs_y"]))
+    out += ["};", ""]
+
+    if sub["contiguous"]:
+        cmap = ".range_start = %d, .range_length = %d, .glyph_id_start = 1,\n" \
+               "        .unicode_list = NULL, .glyph_id_ofs_list = NULL, .list_length = 0, " \
+               ".type = LV_FONT_FMT_TXT_CMAP_FORMAT0_TINY" % (codes[0], len(codes))
+    else:
+        out += ["static const uint16_t unicode_list[] = {",
+                c_bytes([c - codes[0] for c in codes], 8, "0x%x"), "};", ""]
+        cmap = ".range_start = %d, .range_length = %d, .glyph_id_start = 1,\n" \
+               "        .unicode_list = unicode_list, .glyph_id_ofs_list = NULL, .list_length = %d, " \
+               ".type = LV_FONT_FMT_TXT_CMAP_SPARSE_TINY" % (codes[0], codes[-1] - codes[0] + 1, len(codes))
+    out += ["static const lv_font_fmt_txt_cmap_t cmaps[] = {", "    {", "        " + cmap, "    },", "};", ""]
+
+    kern = sub["kern"]
+    if kern:
+        out += [
+            "static const uint8_t kern_left_class_mapping[] = {", c_bytes(kern["left"], 16, "%d"), "};", "",
+            "static const uint8_t kern_right_class_mapping[] = {", c_bytes(kern["right"], 16, "%d"), "};", "",
+            "static const int8_t kern_class_values[] = {", c_bytes(kern["values"], 16, "%d"), "};", "",
+            "static const lv_font_fmt_txt_kern_classes_t kern_classes = {",
+            "    .class_pair_values = kern_class_values,",
+            "    .left_class_mapping = kern_left_class_mapping,",
+            "    .right_class_mapping = kern_right_class_mapping,",
+            "    .left_class_cnt = %d," % kern["left_cnt"],
+            "    .right_class_cnt = %d," % kern["right_cnt"],
+            "};",
+            "",
+        ]
+
+    m = sub["metrics"]
+    out += [
+        "static const lv_font_fmt_txt_dsc_t font_dsc = {",
+        "    .glyph_bitmap = glyph_bitmap,",
+        "    .glyph_dsc = glyph_dsc,",
+        "    .cmaps = cmaps,",
+        "    .kern_dsc = %s," % ("&kern_classes" if kern else "NULL"),
+        "    .kern_scale = %d," % sub["kern_scale"],
+        "    .cmap_num = 1,",
+        "    .bpp = %d," % sub["bpp"],
+        "    .kern_classes = %d," % (1 if kern else 0),
+        "    .bitmap_format = %d," % (1 if sub["compress"] else 0),
+        "};",
+        "",
+        "const lv_font_t %s = {" % name,
+        "    .get_glyph_dsc = lv_font_get_glyph_dsc_fmt_txt,",
+        "    .get_glyph_bitmap = lv_font_get_bitmap_fmt_txt,",
+        "    .line_height = %d," % m["line_height"],
+        "    .base_line = %d," % m["base_line"],
+        "    .subpx = LV_FONT_SUBPX_NONE,",
+        "    .underline_position = %d," % m["underline_position"],
+        "    .underline_thickness = %d," % m["underline_thickness"],
+        "    .dsc = &font_dsc,",
+        "};",
+    ]
+    if sub["compress"]:
+        out[5:5] = ["#if !LV_USE_FONT_COMPRESSED", "#error \"%s is compressed, enable LV_USE_FONT_COMPRESSED\"" % name,
+                    "#endif", ""]
+
+    with open(path, "w", encoding="utf-8") as f:
+        f.write("\n".join(out) + "\n")
+
+
+def main():
+    if len(sys.argv) != 5:
+        sys.stderr.write(__doc__)
+        return 1
+
+    manifest, name, lvgl_dir, output = sys.argv[1:]
+    source, glyphs, compress = read_manifest(manifest, name)
+    font = parse_font(os.path.join(lvgl_dir, "src", "font", source))
+    sub = subset(font, glyphs, compress)
+    write_font(output, name, source, sub)
+
+    full, small = font_size(font), font_size(sub)
+    print("%s: %d of %d glyphs from %s, %dbpp%s, %d bytes instead of %d (saves %d bytes of flash)" % (
+        name, len(sub["codes"]), len(font["glyphs"]) - 1, source, sub["bpp"], " compressed" if compress else "",
+        small, full, full - small))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
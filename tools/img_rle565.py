@@ -0,0 +1,285 @@
+#!/usr/bin/env python3
+"""Convert a PNG into a compressed RGB565 image for main/img_rle565.c.
+
+    img_rle565.py <input.png> <output.c> [--name NAME] [--raw]
+
+Writes a C file defining `const lv_image_dsc_t NAME` whose data is the
+encoded stream below; --raw additionally defines `NAME_raw` as a plain
+RGB565 / RGB565A8 image of the same pixels, for benchmarking the decoder.
+
+Stream layout (little-endian):
+
+    "R565"              magic
+    u16 w, u16 h
+    u8  version (1), u8 flags (bit 0: alpha), u8 block_rows, u8 reserved
+    u32 block offsets[ceil(h / block_rows)], relative to the first block
+    blocks
+
+Each block codes block_rows full-width rows (fewer in the last block) and
+starts from a fresh state, so a decoder can begin at any block. A pixel is
+its RGB565 value plus an 8-bit alpha (always 0xFF without the alpha flag).
+State is the previous pixel (initially opaque black) and a 64-entry index
+of recently seen pixels (initially all zero):
+
+    0x00-0x3F  INDEX    pixel = index[op]
+    0x40-0x7F  RUN      repeat the previous pixel (op & 0x3F) + 1 times
+    0x80-0xFF  LITERAL  (op & 0x7F) + 1 pixels follow, each u16 RGB565
+                        then u8 alpha if the alpha flag is set
+
+INDEX and LITERAL pixels become the previous pixel, and LITERAL pixels are
+stored in the index at hash(pixel). Runs may cross rows within a block.
+
+Only 8-bit, non-interlaced PNGs are read (gray, gray+alpha, RGB, RGBA,
+palette), so the build needs nothing beyond the Python standard library.
+"""
+
+import argparse
+import os
+import struct
+import sys
+import zlib
+
+MAGIC = b"R565"
+VERSION = 1
+FLAG_ALPHA = 0x01
+BLOCK_ROWS = 8
+
+OP_INDEX = 0x00
+OP_RUN = 0x40
+OP_LITERAL = 0x80
+MAX_RUN = 64
+MAX_LITERAL = 128
+
+OPAQUE_BLACK = 0xFF << 16
+
+
+def read_png(path):
+    """Return (width, height, rows of (r, g, b, a) tuples, has_alpha)."""
+    with open(path, "rb") as f:
+        data = f.read()
+
+    if data[:8] != b"\x89PNG\r\n\x1a\n":
+        raise ValueError("%s: not a PNG file" % path)
+
+    pos = 8
+    idat = b""
+    palette = []
+    trns = b""
+    while pos < len(data):
+        length, kind = struct.unpack(">I4s", data[pos:pos + 8])
+        body = data[pos + 8:pos + 8 + length]
+        pos += 12 + length
+        if kind == b"IHDR":
+            w, h, depth, color, _, _, interlace = struct.unpack(">IIBBBBB", body)
+        elif kind == b"PLTE":
+            palette = [tuple(body[i:i + 3]) for i in range(0, len(body), 3)]
+        elif kind == b"tRNS":
+            trns = body
+        elif kind == b"IDAT":
+            idat += body
+        elif kind == b"IEND":
+            break
+
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}.get(color)
+    if depth != 8 or channels is None or interlace:
+        raise ValueError("%s: only 8-bit non-interlaced PNGs are supported" % path)
+
+    raw = zlib.decompress(idat)
+    stride = w * channels
+    rows = []
+    prev = bytearray(stride)
+    pos = 0
+    for _ in range(h):
+        ftype = raw[pos]
+        line = bytearray(raw[pos + 1:pos + 1 + stride])
+        pos += 1 + stride
+        for i in range(stride):
+            a = line[i - channels] if i >= channels else 0
+            b = prev[i]
+            c = prev[i - channels] if i >= channels else 0
+            if ftype == 1:
+                line[i] = (line[i] + a) & 0xFF
+            elif ftype == 2:
+                line[i] = (line[i] + b) & 0xFF
+            elif ftype == 3:
+                line[i] = (line[i] + ((a + b) >> 1)) & 0xFF
+            elif ftype == 4:
+                p = a + b - c
+                pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                pred = a if pa <= pb and pa <= pc else (b if pb <= pc else c)
+                line[i] = (line[i] + pred) & 0xFF
+        prev = line
+
+        px = []
+        for x in range(w):
+            s = line[x * channels:(x + 1) * channels]
+            if color == 0:
+                px.append((s[0], s[0], s[0], 255))
+            elif color == 2:
+                px.append((s[0], s[1], s[2], 255))
+            elif color == 3:
+                r, g, b = palette[s[0]]
+                px.append((r, g, b, trns[s[0]] if s[0] < len(trns) else 255))
+            elif color == 4:
+                px.append((s[0], s[0], s[0], s[1]))
+            else:
+                px.append(tuple(s))
+        rows.append(px)
+
+    has_alpha = any(p[3] != 255 for row in rows for p in row)
+    return w, h, rows, has_alpha
+
+
+def to_pixel(rgba, has_alpha):
+    r, g, b, a = rgba
+    rgb565 = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3)
+    return rgb565 | ((a if has_alpha else 255) << 16)
+
+
+def pixel_hash(px):
+    rgb565, a = px & 0xFFFF, px >> 16
+    r, g, b = rgb565 >> 11, (rgb565 >> 5) & 0x3F, rgb565 & 0x1F
+    return (r * 3 + g * 5 + b * 7 + a * 11) & 63
+
+
+def encode_block(pixels, has_alpha):
+    out = bytearray()
+    index = [0] * 64
+    prev = OPAQUE_BLACK
+    run = 0
+    literal = []
+
+    def flush_run():
+        nonlocal run
+        if run:
+            out.append(OP_RUN | (run - 1))
+            run = 0
+
+    def flush_literal():
+        if literal:
+            out.append(OP_LITERAL | (len(literal) - 1))
+            for px in literal:
+                out.extend(struct.pack("<H", px & 0xFFFF))
+                if has_alpha:
+                    out.append(px >> 16)
+            literal.clear()
+
+    for px in pixels:
+        if px == prev:
+            flush_literal()
+            run += 1
+            if run == MAX_RUN:
+                flush_run()
+            continue
+
+        flush_run()
+        h = pixel_hash(px)
+        if index[h] == px:
+            flush_literal()
+            out.append(OP_INDEX | h)
+        else:
+            index[h] = px
+            literal.append(px)
+            if len(literal) == MAX_LITERAL:
+                flush_literal()
+        prev = px
+
+    flush_run()
+    flush_literal()
+    return out
+
+
+def encode(w, h, rows, has_alpha):
+    pixels = [[to_pixel(p, has_alpha) for p in row] for row in rows]
+    blocks = []
+    for y in range(0, h, BLOCK_ROWS):
+        block = [px for row in pixels[y:y + BLOCK_ROWS] for px in row]
+        blocks.append(encode_block(block, has_alpha))
+
+    header = MAGIC + struct.pack("<HHBBBB", w, h, VERSION, FLAG_ALPHA if has_alpha else 0, BLOCK_ROWS, 0)
+    offsets = bytearray()
+    offset = 0
+    for block in blocks:
+        offsets.extend(struct.pack("<I", offset))
+        offset += len(block)
+
+    return header + offsets + b"".join(blocks)
+
+
+def raw_planes(w, h, rows, has_alpha):
+    color = bytearray()
+    alpha = bytearray()
+    for row in rows:
+        for p in row:
+            color.extend(struct.pack("<H", to_pixel(p, has_alpha) & 0xFFFF))
+            alpha.append(p[3])
+    return color + alpha if has_alpha else color
+
+
+def c_array(name, data):
+    lines = ["static const uint8_t %s[%d] = {" % (name, len(data))]
+    for i in range(0, len(data), 16):
+        lines.append("    " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+    lines.append("};")
+    return "\n".join(lines)
+
+
+def c_image(name, map_name, cf, w, h, stride, size):
+    return "\n".join([
+        "const lv_image_dsc_t %s = {" % name,
+        "    .header = {",
+        "        .magic = LV_IMAGE_HEADER_MAGIC,",
+        "        .cf = %s," % cf,
+        "        .w = %d," % w,
+        "        .h = %d," % h,
+        "        .stride = %d," % stride,
+        "    },",
+        "    .data_size = %d," % size,
+        "    .data = %s," % map_name,
+        "};",
+    ])
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("input")
+    parser.add_argument("output")
+    parser.add_argument("--name", help="C symbol, default img_<input basename>")
+    parser.add_argument("--raw", action="store_true", help="also emit NAME_raw, the uncompressed image")
+    args = parser.parse_args()
+
+    name = args.name or "img_" + os.path.splitext(os.path.basename(args.input))[0]
+    w, h, rows, has_alpha = read_png(args.input)
+    stream = encode(w, h, rows, has_alpha)
+    raw = raw_planes(w, h, rows, has_alpha)
+
+    # The decoder claims RAW images whose data starts with MAGIC
+    parts = [
+        "// Generated by tools/img_rle565.py from %s, do not edit" % os.path.basename(args.input),
+        "",
+        "#include <lvgl.h>",
+        "",
+        c_array(name + "_map", stream),
+        "",
+        c_image(name, name + "_map", "LV_COLOR_FORMAT_RAW_ALPHA" if has_alpha else "LV_COLOR_FORMAT_RAW",
+                w, h, 0, len(stream)),
+    ]
+    if args.raw:
+        parts += [
+            "",
+            c_array(name + "_raw_map", raw),
+            "",
+            c_image(name + "_raw", name + "_raw_map", "LV_COLOR_FORMAT_RGB565A8" if has_alpha else "LV_COLOR_FORMAT_RGB565",
+                    w, h, w * 2, len(raw)),
+        ]
+
+    with open(args.output, "w") as f:
+        f.write("\n".join(parts) + "\n")
+
+    print("%s: %dx%d%s, %d bytes raw -> %d bytes (%d%%)" % (
+        os.path.basename(args.input), w, h, " with alpha" if has_alpha else "",
+        len(raw), len(stream), len(stream) * 100 // len(raw)))
+
+
+if __name__ == "__main__":
+    sys.exit(main())